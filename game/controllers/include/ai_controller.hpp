@@ -11,7 +11,6 @@
 #include <mutex>
 
 #include <iostream>
-#include <random>
 #include <string>
 #include <thread>
 #include <unordered_map>
@@ -114,42 +113,49 @@ namespace chess::controller {
         *pieces::piece::itopos( 4, 4 ), *pieces::piece::itopos( 4, 5 ), *pieces::piece::itopos( 5, 5 ),
         *pieces::piece::itopos( 5, 4 ) };
 
-    struct zobrist_t {
-        uint64_t piece_square[12][64];
-        uint64_t castling_availability[4];
-        uint64_t white_to_move;
-
-        zobrist_t()
-        {
-            std::mt19937_64                           rng( 20250517 );
-            std::uniform_int_distribution< uint64_t > distribution;
-
-            for ( int i = 0; i < 12; i++ ) {
-                for ( int j = 0; j < 64; j++ ) {
-                    piece_square[i][j] = distribution( rng );
-                }
-            }
-
-            for ( int i = 0; i < 4; i++ ) {
-                castling_availability[i] = distribution( rng );
-            }
-
-            white_to_move = distribution( rng );
-        }
-    };
-
     class ai_controller : public controller {
     private:
-        chromosome_t chromosome;
+        // the evaluation terms in chromosome order, each is weighted by the chromosome value at its index. the last one
+        // stands for the six position weight grids: their dot product with the one-hot piece square counts is the sum
+        // the board keeps as it plays, so it enters with a weight of 1
+        enum term_index : std::size_t {
+            material_term,
+            mobility_term,
+            castling_term,
+            development_term,
+            doubled_pawn_term,
+            isolated_pawn_term,
+            connected_pawn_term,
+            passed_pawn_term,
+            enemy_king_pressure_term,
+            piece_defense_term,
+            bishop_pair_term,
+            connected_rooks_term,
+            king_centralization_term,
+            knight_outpost_term,
+            blocked_piece_term,
+            space_control_term,
+            king_shield_term,
+            king_pressure_term,
+            piece_square_term,
+            num_terms,
+        };
+
+        // the terms padded with zeros to a whole number of 8 float lanes
+        using feature_vector = std::array< float, ( num_terms + 7 ) / 8 * 8 >;
 
-        zobrist_t zobrist_hash;
+        chromosome_t chromosome;
+        // the term weights of the chromosome laid out like the terms, for the vector dot product
+        alignas( 32 ) feature_vector term_weights;
+        // the chromosome's position weights as a table the searched games sum incrementally
+        game::piece_square_table piece_squares;
 
         struct cache_entry {
             float score;
             int   depth;
         };
 
-        mutable std::unordered_map< uint64_t, cache_entry > position_cache;
+        mutable std::unordered_map< game::zobrist_key_t, cache_entry > position_cache;
         mutable std::mutex cache_mutex;
         
         bool        should_close;
@@ -157,33 +163,19 @@ namespace chess::controller {
 
         void play();
 
-        uint64_t compute_zobrist_hash( const game::board & b ) const;
-        float    compute_material_score( const chess_game & game, const bool white ) const;
-        float    compute_piece_mobility( const chess_game & game, const bool white ) const;
-        float    compute_castling_bonus( const chess_game & game, const bool white ) const;
-        float    compute_development_speed( const chess_game & game, const bool white ) const;
-        float    compute_doubled_pawn_score( const chess_game & game, const bool white ) const;
-        float    compute_isolated_pawn_score( const chess_game & game, const bool white ) const;
-        float    compute_connected_pawn_score( const chess_game & game, const bool white ) const;
-        float    compute_passed_pawn_score( const chess_game & game, const bool white ) const;
-        float    compute_king_pressure_score( const chess_game & game, const bool white ) const;
-        float    compute_piece_defense_score( const chess_game & game, const bool white ) const;
-        float    compute_bishop_pair_score( const chess_game & game, const bool white ) const;
-        float    compute_connected_rooks_score( const chess_game & game, const bool white ) const;
-        float    compute_king_centralization_score( const chess_game & game, const bool white ) const;
-        float    compute_knight_outpost_score( const chess_game & game, const bool white ) const;
-        float    compute_blocked_piece_score( const chess_game & game, const bool white ) const;
-        float    compute_space_control_score( const chess_game & game, const bool white ) const;
-        float    compute_king_shield_score( const chess_game & game, const bool white ) const;
-
         float  move_score( const chess_game & game, const move_t move ) const;
-        float  order_moves( const chess_game & game ) const;
+        // sorts by move_score, best first, and returns how many of the moves do not lose material
+        std::size_t order_moves( const chess_game & game, game::move_list & moves ) const;
         float  minimax( chess_game & game, const int depth, float alpha, float beta,
                         bool maximizing_player ) const;
         move_t select_best_move( const int depth ) const;
         float  evaluate_position() const;
         float  evaluate_position( const chess_game & board, const bool white ) const;
-        // returns a value that should be added to the score of the entire position
+        // fills features with the terms of the position for the given side, evaluate_position is their dot product
+        // with term_weights
+        void extract_features( const chess_game & game, const bool white, feature_vector & features ) const;
+        // the chromosome's position weights summed over the pieces from white's side, the piece_square_term. read in
+        // constant time from games searched with piece_squares
         float position_score( const chess_game & game ) const;
 
     public:
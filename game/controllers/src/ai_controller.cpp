@@ -4,988 +4,455 @@
 #include "space.hpp"
 #include <ai_controller.hpp>
 #include <algorithm>
+#include <attacks.hpp>
+#include <bit>
 #include <chrono>
 #include <exception>
 #include <iostream>
 #include <stdexcept>
 #include <thread>
 #include <future>
+#if defined( __AVX2__ ) || defined( __SSE2__ )
+#include <immintrin.h>
+#endif
+#include <map>
+#include <memory>
 #include <mutex>
+#include <tuple>
 
 namespace chess::controller {
-    ai_controller::ai_controller( chromosome_t chromie ) : controller(), chromosome( chromie ) {}
-
-    float ai_controller::evaluate_position() const { return evaluate_position( game, true ); }
-
-    uint64_t ai_controller::compute_zobrist_hash( const game::board & b ) const
-    {
-        uint64_t hash = 0;
-
-        for ( int i = 1; i <= 8; i++ ) {
-            for ( int j = 1; j <= 8; j++ ) {
-                auto space = b.get( pieces::piece::itopos( i, j ).value() );
-
-                if ( !space.piece ) {
-                    continue;
-                }
-
-                int piece_index;
-                switch ( space.piece->type() ) {
-                case pieces::name_t::pawn:
-                    piece_index = 0;
-                    break;
-                case pieces::name_t::knight:
-                    piece_index = 1;
-                    break;
-                case pieces::name_t::bishop:
-                    piece_index = 2;
-                    break;
-                case pieces::name_t::rook:
-                    piece_index = 3;
-                    break;
-                case pieces::name_t::queen:
-                    piece_index = 4;
-                    break;
-                case pieces::name_t::king:
-                    piece_index = 5;
-                    break;
-                }
-
-                if ( !space.piece->colour() ) {
-                    piece_index += 6;
-                }
-
-                int square = ( i - 1 ) * 8 + ( j - 1 );
-
-                hash ^= zobrist_hash.piece_square[piece_index][square];
-            }
+    namespace {
+        constexpr std::pair< pieces::name_t, int > material[] = {
+            { pieces::name_t::rook, values::rook },     { pieces::name_t::knight, values::knight },
+            { pieces::name_t::bishop, values::bishop }, { pieces::name_t::king, values::king },
+            { pieces::name_t::queen, values::queen },   { pieces::name_t::pawn, values::pawn } };
+
+        // the squares the given pawns capture on towards the A file and towards the H file
+        std::pair< game::bitboard_t, game::bitboard_t > pawn_captures( game::bitboard_t const pawns, bool const white )
+        {
+            auto west = pawns & ~game::file_a_bb;
+            auto east = pawns & ~game::file_h_bb;
+            return white ? std::pair{ west << 7, east << 9 } : std::pair{ west >> 9, east >> 7 };
         }
 
-        if ( game.white_move() ) {
-            hash ^= zobrist_hash.white_to_move;
+        // bb with every square up (or down) its file from each set square added
+        game::bitboard_t file_fill( game::bitboard_t bb, bool const up )
+        {
+            for ( int step : { 8, 16, 32 } ) {
+                bb |= up ? bb << step : bb >> step;
+            }
+            return bb;
         }
 
-        if ( game.king_side_castle_white ) {
-            hash ^= zobrist_hash.castling_availability[0];
-        }
-        if ( game.queen_side_castle_white ) {
-            hash ^= zobrist_hash.castling_availability[1];
-        }
-        if ( game.king_side_castle_black ) {
-            hash ^= zobrist_hash.castling_availability[2];
-        }
-        if ( game.queen_side_castle_black ) {
-            hash ^= zobrist_hash.castling_availability[3];
-        }
+        // the pawn terms and capture squares of both colours (1 is white), they depend on the pawns alone
+        struct pawn_entry {
+            game::zobrist_key_t key;
+            game::bitboard_t    west[2];  // squares the pawns capture on towards the A file
+            game::bitboard_t    east[2];  // and towards the H file
+            std::uint8_t        doubled[2];
+            std::uint8_t        isolated[2];
+            std::uint8_t        passed[2];
+        };
 
-        return hash;
-    }
+        constexpr std::size_t pawn_table_size = 1 << 14;
 
-    // TODO: add to game class
-    std::vector< game::space > attacks( std::vector< move_t > const & legal_moves, pieces::position_t const & pos )
-    {
-        std::vector< game::space > attackers;
+        // looks the pawn structure of game up in this thread's table and fills the entry in on a miss. a slot that
+        // was never written holds the entry of a board without pawns, whose key is 0
+        pawn_entry const & probe_pawns( chess_game const & game )
+        {
+            thread_local std::unique_ptr< pawn_entry[] > table = std::make_unique< pawn_entry[] >( pawn_table_size );
 
-        for ( auto & move : legal_moves ) {
-            if ( move.second.position() == pos ) {
-                attackers.push_back( move.first );
+            auto   key   = game.pawn_hash();
+            auto & entry = table[key % pawn_table_size];
+            if ( entry.key == key ) {
+                return entry;
             }
-        }
 
-        return attackers;
-    }
+            entry.key = key;
+            for ( bool const white : { false, true } ) {
+                auto pawns       = game.piece_set( pieces::name_t::pawn, white );
+                auto enemy_pawns = game.piece_set( pieces::name_t::pawn, !white );
 
-    float ai_controller::compute_material_score( const chess_game & game, const bool white ) const
-    {
-        float score = 0.f;
-        for ( int i = 1; i <= 8; i++ ) {
-            for ( int j = 1; j <= 8; j++ ) {
-                auto & space = game.get( pieces::piece::itopos( i, j ).value() );
-
-                if ( !space.piece )
-                    continue;
-
-                float material_score = 0.f;
-
-                switch ( space.piece->type() ) {
-                case pieces::name_t::rook:
-                    material_score += values::rook;
-                    break;
-                case pieces::name_t::knight:
-                    material_score += values::knight;
-                    break;
-                case pieces::name_t::bishop:
-                    material_score += values::bishop;
-                    break;
-                case pieces::name_t::king:
-                    material_score += values::king;
-                    break;
-                case pieces::name_t::queen:
-                    material_score += values::queen;
-                    break;
-                case pieces::name_t::pawn:
-                    material_score += values::pawn;
-                    break;
-                }
+                std::tie( entry.west[white], entry.east[white] ) = pawn_captures( pawns, white );
 
-                if ( space.piece->colour() == white ) {
-                    score += material_score;
-                }
-                else {
-                    score -= material_score;
+                int      doubled = 0;
+                unsigned files   = 0;  // one bit per file that has a pawn on it, A in bit 0
+                for ( int file = 0; file < 8; file++ ) {
+                    auto count = game::popcount( pawns & ( game::file_a_bb << file ) );
+                    doubled += std::max( count - 1, 0 );
+                    files |= unsigned{ count > 0 } << file;
                 }
-            }
-        }
-
-        return score;
-    }
 
-    float ai_controller::compute_piece_mobility( const chess_game & game, const bool white ) const
-    {
-        float score = 0.0f;
-        auto  color = white;
-
-        std::chrono::high_resolution_clock::time_point start, end, startl, endl;
-        std::chrono::microseconds                      duration;
+                // a pawn counts as passed when it is not behind an enemy pawn on its own file, pawns on the
+                // adjacent files are not looked at
+                auto behind_enemy_pawns =
+                    white ? file_fill( enemy_pawns >> 8, false ) : file_fill( enemy_pawns << 8, true );
 
-        start                                  = std::chrono::high_resolution_clock::now();
-        auto moves                             = game.legal_moves();
-        end                                    = std::chrono::high_resolution_clock::now();
-        duration                               = std::chrono::duration_cast< std::chrono::microseconds >( end - start );
-        chess_game::attack_map game_attack_map = game.game_attack_map;
-
-        for ( auto const & move : moves ) {
-            int num_defenders = game_attack_map.num_attackers( move.second, white );
-            int num_attackers = game_attack_map.num_attackers( move.second, !white );
+                auto isolated = std::popcount( files & ~( files << 1 | files >> 1 ) );
 
-            if ( num_defenders >= num_attackers ) {
-                score++;
+                entry.doubled[white]  = static_cast< std::uint8_t >( doubled );
+                entry.isolated[white] = static_cast< std::uint8_t >( isolated );
+                entry.passed[white]   = static_cast< std::uint8_t >( game::popcount( pawns & ~behind_enemy_pawns ) );
             }
-        }
-        return score;
-    }
 
-    float ai_controller::compute_castling_bonus( const chess_game & game, const bool white ) const
-    {
-        float score = 0;
-
-        if ( game.can_castle( white ) ) {
-            score += 1;
-        }
-        else {
-            std::vector< std::string > move_history = game.get_move_history();
-            if ( move_history.size() > 2 ) {
-                std::string second_last = move_history.at( move_history.size() - 2 );
-                if ( second_last == "O-O" || second_last == "O-O-O" ) {
-                    score += 2;
-                }
-            }
+            return entry;
         }
 
-        return score;
-    }
+        // what the piece counts alone decide
+        struct material_entry {
+            game::material_key_t key;
+            int                  balance;         // values:: of white's pieces minus black's
+            bool                 bishop_pair[2];  // by colour, 1 is white
+            std::uint8_t         phase;           // 24 with the knights, bishops, rooks and queens of the start or more
+        };
 
-    float ai_controller::compute_development_speed( const chess_game & game, const bool white ) const
-    {
-        float score = 0.0f;
+        constexpr int material_table_bits = 12;
 
-        pieces::rank_t pawn_starting_rank;
-        pieces::rank_t piece_starting_rank;
-
-        if ( white ) {
-            pawn_starting_rank  = pieces::rank_t::two;
-            piece_starting_rank = pieces::rank_t::one;
-        }
-        else {
-            pawn_starting_rank  = pieces::rank_t::seven;
-            piece_starting_rank = pieces::rank_t::eight;
-        }
+        // looks the material of game up in this thread's table and fills the entry in on a miss. a slot that was
+        // never written holds the entry of an empty board, whose key is 0
+        material_entry const & probe_material( chess_game const & game )
+        {
+            thread_local std::unique_ptr< material_entry[] > table =
+                std::make_unique< material_entry[] >( std::size_t{ 1 } << material_table_bits );
 
-        for ( int i = 1; i <= 8; i++ ) {
-            for ( int j = 1; j <= 8; j++ ) {
-                auto & space = game.get( pieces::piece::itopos( i, j ).value() );
-
-                if ( !space.piece )
-                    continue;
-
-                if ( space.piece->colour() == white ) {
-                    if ( space.piece->type() == pieces::name_t::pawn ) {
-                        if ( space.piece->position().first != pawn_starting_rank ) {
-                            score += 0.5;
-                        }
-                    }
-                    else {
-                        if ( space.piece->position().first != piece_starting_rank ) {
-                            score += 1.0;
-                        }
-                    }
-                }
+            // the counts sit in the low bits of the key, so they are mixed before picking a slot
+            auto   key   = game.material_key();
+            auto & entry = table[( key * 0x9E3779B97F4A7C15ULL ) >> ( 64 - material_table_bits )];
+            if ( entry.key == key ) {
+                return entry;
             }
-        }
 
-        return score;
-    }
-
-    float ai_controller::compute_doubled_pawn_score( const chess_game & game, const bool white ) const
-    {
-        float score = 0.0f;
+            auto count = [key]( pieces::name_t const type, bool const white ) {
+                return game::material_count( key, game::make_piece_index( type, white ) );
+            };
 
-        std::map< pieces::file_t, int > pawn_counts;
-
-        for ( int i = 1; i <= 8; i++ ) {
-            for ( int j = 1; j <= 8; j++ ) {
-                auto & space = game.get( pieces::piece::itopos( i, j ).value() );
-
-                if ( !space.piece )
-                    continue;
-
-                if ( space.piece->colour() == white ) {
-                    if ( space.piece->type() == pieces::name_t::pawn ) {
-                        pawn_counts[space.piece->position().second]++;
-                    }
-                }
+            entry.key     = key;
+            entry.balance = 0;
+            for ( auto const & [type, value] : material ) {
+                entry.balance += value * ( count( type, true ) - count( type, false ) );
             }
-        }
 
-        for ( auto c : pawn_counts ) {
-            if ( c.second > 1 ) {
-                score += ( c.second - 1 );
-            }
-        }
+            int phase = 0;
+            for ( bool const white : { false, true } ) {
+                entry.bishop_pair[white] = count( pieces::name_t::bishop, white ) > 1;
 
-        return score;
-    }
-
-    float ai_controller::compute_isolated_pawn_score( const chess_game & game, const bool white ) const
-    {
-        float              score = 0.0f;
-        std::vector< int > pawn_files;
-
-        for ( int i = 1; i <= 8; i++ ) {
-            for ( int j = 1; j <= 8; j++ ) {
-                auto & space = game.get( pieces::piece::itopos( i, j ).value() );
-
-                if ( !space.piece )
-                    continue;
-
-                if ( space.piece->colour() == white ) {
-                    if ( space.piece->type() == pieces::name_t::pawn &&
-                         std::find( pawn_files.begin(), pawn_files.end(),
-                                    static_cast< int >( space.piece->position().second ) ) == pawn_files.end() ) {
-                        pawn_files.push_back( static_cast< int >( space.piece->position().second ) );
-                    }
-                }
+                phase += count( pieces::name_t::knight, white ) + count( pieces::name_t::bishop, white ) +
+                         2 * count( pieces::name_t::rook, white ) + 4 * count( pieces::name_t::queen, white );
             }
-        }
+            entry.phase = static_cast< std::uint8_t >( std::min( phase, 24 ) );
 
-        bool isolated_left  = false;
-        bool isolated_right = false;
-        int  file;
-        for ( int i = 0; i < pawn_files.size(); i++ ) {
-            file = static_cast< int >( pawn_files[i] );
-            isolated_left =
-                file - 1 < 1 || std::find( pawn_files.begin(), pawn_files.end(), file - 1 ) == pawn_files.end();
-            isolated_right =
-                file + 1 > 8 || std::find( pawn_files.begin(), pawn_files.end(), file + 1 ) == pawn_files.end();
-
-            if ( isolated_left && isolated_right ) {
-                score += 1;
-            }
+            return entry;
         }
 
-        return score;
-    }
-
-    float ai_controller::compute_connected_pawn_score( const chess_game & game, const bool white ) const
+        // dot product of two feature vectors. lane i sums elements i, i + 8, ... in turn and the lanes are then added
+        // pairwise, the scalar version adds in the same order so it scores a position like the vector versions
+        template < std::size_t size >
+        float weighted_sum( std::array< float, size > const & features, std::array< float, size > const & weights )
+        {
+            static_assert( size % 8 == 0 );
+
+#if defined( __AVX2__ )
+            auto sum = _mm256_setzero_ps();
+            for ( std::size_t i = 0; i < size; i += 8 ) {
+                auto product = _mm256_mul_ps( _mm256_load_ps( &features[i] ), _mm256_load_ps( &weights[i] ) );
+                sum          = _mm256_add_ps( sum, product );
+            }
+            auto quad = _mm_add_ps( _mm256_castps256_ps128( sum ), _mm256_extractf128_ps( sum, 1 ) );
+#elif defined( __SSE2__ )
+            auto low  = _mm_setzero_ps();
+            auto high = _mm_setzero_ps();
+            for ( std::size_t i = 0; i < size; i += 8 ) {
+                auto product_low  = _mm_mul_ps( _mm_load_ps( &features[i] ), _mm_load_ps( &weights[i] ) );
+                auto product_high = _mm_mul_ps( _mm_load_ps( &features[i + 4] ), _mm_load_ps( &weights[i + 4] ) );
+
+                low  = _mm_add_ps( low, product_low );
+                high = _mm_add_ps( high, product_high );
+            }
+            auto quad = _mm_add_ps( low, high );
+#endif
+
+#if defined( __AVX2__ ) || defined( __SSE2__ )
+            auto pair = _mm_add_ps( quad, _mm_movehl_ps( quad, quad ) );
+            return _mm_cvtss_f32( _mm_add_ss( pair, _mm_shuffle_ps( pair, pair, 1 ) ) );
+#else
+            float lanes[8] = {};
+            for ( std::size_t i = 0; i < size; i++ ) {
+                lanes[i % 8] += features[i] * weights[i];
+            }
+            float quad[4] = { lanes[0] + lanes[4], lanes[1] + lanes[5], lanes[2] + lanes[6], lanes[3] + lanes[7] };
+            return ( quad[0] + quad[2] ) + ( quad[1] + quad[3] );
+#endif
+        }
+    }  // namespace
+
+    ai_controller::ai_controller( chromosome_t chromie )
+        : controller(), chromosome( chromie ),
+          term_weights{ chromosome.material_score_bonus,
+                        chromosome.piece_mobility_bonus,
+                        chromosome.castling_bonus,
+                        chromosome.development_speed_bonus,
+                        chromosome.doubled_pawn_penalty,
+                        chromosome.isolated_pawn_penalty,
+                        chromosome.connected_pawn_bonus,
+                        chromosome.passed_pawn_bonus,
+                        chromosome.enemy_king_pressure_bonus,
+                        chromosome.piece_defense_bonus,
+                        chromosome.bishop_pair_bonus,
+                        chromosome.connected_rooks_bonus,
+                        0.0f,  // king centralization is not scored
+                        chromosome.knight_outpost_bonus,
+                        chromosome.blocked_piece_penalty,
+                        chromosome.space_control_in_opponent_half_bonus,
+                        chromosome.king_shield_bonus,
+                        chromosome.king_pressure_penalty,
+                        1.0f },
+          piece_squares{}
     {
-        float                      score = 0.0f;
-        std::vector< game::space > pawn_squares;
-
-        for ( int i = 1; i <= 8; i++ ) {
-            for ( int j = 1; j <= 8; j++ ) {
-                auto & space = game.get( pieces::piece::itopos( i, j ).value() );
-
-                if ( !space.piece )
-                    continue;
-
-                if ( space.piece->colour() == white ) {
-                    if ( space.piece->type() == pieces::name_t::pawn ) {
-                        pawn_squares.push_back( space );
-                    }
-                }
-            }
-        }
-
-        int rank_direction;
-        if ( white ) {
-            rank_direction = 1;
-        }
-        else {
-            rank_direction = -1;
-        }
-
-        int            rank, file;
-        pieces::rank_t behind_rank;
-        for ( int i = 0; i < pawn_squares.size(); i++ ) {
-            rank = static_cast< int >( pawn_squares[i].piece->position().first );
-            file = static_cast< int >( pawn_squares[i].piece->position().second );
-
-            if ( 1 <= rank + rank_direction && rank + rank_direction <= 8 && 1 <= file - 1 ) {
+        std::pair< pieces::name_t, chromosome_t::grid_t const & > const weights[] = {
+            { pieces::name_t::pawn, chromosome.pawn_position_weights },
+            { pieces::name_t::knight, chromosome.knight_position_weights },
+            { pieces::name_t::bishop, chromosome.bishop_position_weights },
+            { pieces::name_t::rook, chromosome.rook_position_weights },
+            { pieces::name_t::queen, chromosome.queen_position_weights },
+            { pieces::name_t::king, chromosome.king_position_weights } };
 
-                auto & left_space = game.get( pieces::piece::itopos( rank + rank_direction, file - 1 ).value() );
-                if ( left_space.piece && left_space.piece->colour() == white ) {
-                    score += 1;
-                }
-            }
+        // rows count from white's side, black reads its table mirrored vertically and scores against white
+        for ( auto const & [type, grid] : weights ) {
+            for ( game::square_t sq = 0; sq < game::num_squares; sq++ ) {
+                int rank = game::rank_of( sq );
+                int col  = game::file_of( sq ) - 1;
 
-            if ( 1 <= rank + rank_direction && rank + rank_direction <= 8 && file + 1 <= 8 ) {
-                auto & right_space = game.get( pieces::piece::itopos( rank + rank_direction, file + 1 ).value() );
-
-                if ( right_space.piece && right_space.piece->colour() == white ) {
-                    score += 1;
-                }
+                piece_squares.score[game::make_piece_index( type, true )][sq]  = grid[rank - 1][col];
+                piece_squares.score[game::make_piece_index( type, false )][sq] = -grid[8 - rank][col];
             }
         }
-
-        return score;
     }
-    // TODO: need to check adjacent files
-    float ai_controller::compute_passed_pawn_score( const chess_game & game, const bool white ) const
-    {
-        float                      score = 0.0f;
-        std::vector< game::space > pawn_squares;
-
-        for ( int i = 1; i <= 8; i++ ) {
-            for ( int j = 1; j <= 8; j++ ) {
-                auto & space = game.get( pieces::piece::itopos( i, j ).value() );
 
-                if ( !space.piece )
-                    continue;
+    float ai_controller::evaluate_position() const { return evaluate_position( game, true ); }
 
-                if ( space.piece->colour() == white ) {
-                    if ( space.piece->type() == pieces::name_t::pawn ) {
-                        pawn_squares.push_back( space );
-                    }
-                }
-            }
+    float ai_controller::position_score( const chess_game & game ) const
+    {
+        // games searched by this controller keep the sum as they play
+        if ( game.get_piece_square_table() == &piece_squares ) {
+            return game.table_score();
         }
 
-        int pawn_rank, pawn_file, blocked;
-        for ( int i = 0; i < pawn_squares.size(); i++ ) {
-            pawn_rank = static_cast< int >( pawn_squares[i].piece->position().first );
-            pawn_file = static_cast< int >( pawn_squares[i].piece->position().second );
-            blocked   = 0;
-            if ( white ) {
-                for ( int j = pawn_rank + 1; j <= 8; j++ ) {
-                    auto & space = game.get( pieces::piece::itopos( j, pawn_file ).value() );
-                    if ( space.piece && space.piece->colour() != white &&
-                         space.piece->type() == pieces::name_t::pawn ) {
-                        blocked = 1;
-                    }
-                }
-            }
-            else {
-                for ( int j = pawn_rank - 1; j >= 1; j-- ) {
-                    auto & space = game.get( pieces::piece::itopos( j, pawn_file ).value() );
-                    if ( space.piece && space.piece->colour() != white &&
-                         space.piece->type() == pieces::name_t::pawn ) {
-                        blocked = 1;
-                    }
-                }
-            }
-            if ( !blocked ) {
-                score += 1;
-            }
+        float score = 0.f;
+        for ( auto occupied = game.occupancy(); occupied; ) {
+            auto sq = game::pop_lsb( occupied );
+            score += piece_squares.score[game.piece_on( sq )][sq];
         }
-
         return score;
     }
 
-    float ai_controller::compute_king_pressure_score( const chess_game & game, const bool white ) const
+    float ai_controller::evaluate_position( const chess_game & game, const bool white ) const
     {
-        float score = 0.0f;
-
-        int king_rank, king_file;
-
-        pieces::position_t king_position;
-        if ( white ) {
-            king_position = game.white_king.get().position();
-        }
-        else {
-            king_position = game.black_king.get().position();
+        if ( game.checkmate( false ) ) {
+            return 1000;
         }
 
-        king_rank             = static_cast< int >( king_position.first );
-        king_file             = static_cast< int >( king_position.second );
-        auto &     king_space = game.get( pieces::piece::itopos( king_rank, king_file ).value() );
-        std::array directions = { std::pair{ -1, -1 }, std::pair{ 0, -1 }, std::pair{ 1, -1 }, std::pair{ -1, 0 },
-                                  std::pair{ 1, 0 },   std::pair{ -1, 1 }, std::pair{ 0, 1 },  std::pair{ 1, 1 } };
+        alignas( 32 ) feature_vector features{};
+        extract_features( game, white, features );
+        return weighted_sum( features, term_weights );
+    }
 
-        chess_game::attack_map game_attack_map = game.game_attack_map;
+    void ai_controller::extract_features( const chess_game & game, const bool white, feature_vector & features ) const
+    {
+        // everything the terms look at is gathered once here, each term below is then a few operations on these sets
+        auto occupied    = game.occupancy();
+        auto own         = game.colour_set( white );
+        auto own_pawns   = game.piece_set( pieces::name_t::pawn, white );
+        auto enemy_pawns = game.piece_set( pieces::name_t::pawn, !white );
 
-        for ( const auto & [df, dr] : directions ) {
-            int f = king_file + df;
-            int r = king_rank + dr;
-            if ( f >= 1 && f <= 8 && r >= 1 && r <= 8 ) {
-                auto pos = game.get( pieces::piece::itopos( r, f ).value() );
+        auto const & pawn_info     = probe_pawns( game );
+        auto const & material_info = probe_material( game );
 
-                if ( game_attack_map.has_attackers( pos, white ) ) {
-                    score += 1;
-                }
+        // squares attacked by each colour, 1 is white
+        game::bitboard_t attacked[2] = { game::empty_bb, game::empty_bb };
+        for ( int sq = 0; sq < game::num_squares; sq++ ) {
+            for ( int colour = 0; colour < 2; colour++ ) {
+                attacked[colour] |= game::bitboard_t{ game.game_attack_map.attackers[colour][sq] != 0 } << sq;
             }
         }
 
-        chess_game temp_game = game;
-        for ( int i = 1; i <= 8; i++ ) {
-            for ( int j = 1; j <= 8; j++ ) {
-                auto & space = temp_game.get( pieces::piece::itopos( i, j ).value() );
+        // the legal moves of the side being evaluated, whoever is to move
+        game::move_list moves;
+        game.generate< game::gen_type::legal >( white, moves );
 
-                if ( space.piece && space.piece->colour() == white && space.piece->type() != pieces::name_t::king ) {
-                    temp_game.remove_piece_at( space.piece->position() );
-                }
+        // a side's pressure on its own king, the squares around it it attacks and whether it guards the king itself
+        auto king_pressure = [&]( bool const colour ) {
+            auto king = game.king_square( colour );
+            if ( king == game::num_squares ) {
+                return 0.0f;
             }
-        }
-
-        chess_game::attack_map temp_attack_map = game.generate_attack_map( temp_game.get_board() );
-        score += temp_attack_map.has_attackers( king_space, white );
-
-        return score;
-    }
 
-    float ai_controller::compute_piece_defense_score( const chess_game & game, const bool white ) const
-    {
-        chess_game::attack_map game_attack_map = game.game_attack_map;
-        float                  score           = 0.0f;
-        for ( int i = 1; i <= 8; i++ ) {
-            for ( int j = 1; j <= 8; j++ ) {
-                auto space = game.get( pieces::piece::itopos( i, j ).value() );
-
-                if ( !( space.piece && space.piece->colour() == white ) ) {
-                    continue;
-                }
+            // the king's square with every other piece of its colour lifted off the board
+            auto lifted  = game.colour_set( colour ) & ~game.piece_set( pieces::name_t::king, colour );
+            auto guarded = ( game.attackers_to( king, colour, occupied & ~lifted ) & ~lifted ) != 0;
+            return static_cast< float >( game::popcount( game::king_attacks[king] & attacked[colour] ) + guarded );
+        };
 
-                if ( game_attack_map.has_attackers( space, white ) ) {
-                    score++;
-                }
-            }
-        }
-        return score;
-    }
+        auto material_score = static_cast< float >( white ? material_info.balance : -material_info.balance );
+        features[material_term] = material_score;
 
-    float ai_controller::compute_connected_rooks_score( const chess_game & game, const bool white ) const
-    {
-        float                      score = 0.0f;
-        std::vector< game::space > rooks;
-
-        for ( int i = 1; i <= 8; i++ ) {
-            for ( int j = 1; j <= 8; j++ ) {
-                auto & space = game.get( pieces::piece::itopos( i, j ).value() );
-
-                if ( space.piece && space.piece->colour() == white && space.piece->type() == pieces::name_t::rook ) {
-                    rooks.push_back( space );
-                }
+        // a move counts if the piece is not lost for less than it takes on the destination
+        float            piece_mobility_score = 0.0f;
+        game::bitboard_t movable              = game::empty_bb;
+        for ( auto const & move : moves ) {
+            if ( game.see_ge( move, 0 ) ) {
+                piece_mobility_score++;
             }
+            movable |= game::square_bb( move.from() );
         }
+        features[mobility_term] = piece_mobility_score;
 
-        int rook1_rank, rook2_rank;
-        int rook1_file, rook2_file;
-
-        for ( int i = 0; i < rooks.size(); i++ ) {
-            for ( int j = i + 1; j < rooks.size(); j++ ) {
-                rook1_rank = static_cast< int >( rooks[i].position().first );
-                rook1_file = static_cast< int >( rooks[i].position().second );
-
-                rook2_rank = static_cast< int >( rooks[j].position().first );
-                rook2_file = static_cast< int >( rooks[j].position().second );
-
-                if ( rook1_rank == rook2_rank ) {
-                    int step    = ( rook1_file < rook2_file ) ? 1 : -1;
-                    int blocked = 0;
-                    for ( int file = rook1_file + step; file != rook2_file; file += step ) {
-                        auto s = pieces::piece::itopos( rook1_rank, file );
-                        if ( !s.has_value() )
-                            continue;
-
-                        auto & space = game.get( s.value() );
-                        if ( space.piece ) {
-                            blocked = 1;
-                            break;
-                        }
-                    }
-
-                    if ( !blocked ) {
-                        score += 1;
-                    }
-                }
-                else if ( rook1_file == rook2_file ) {
-                    int step    = ( rook1_rank < rook2_rank ) ? 1 : -1;
-                    int blocked = 0;
-                    for ( int rank = rook1_rank + step; rank != rook2_rank; rank += step ) {
-                        auto s = pieces::piece::itopos( rank, rook1_file );
-                        if ( !s.has_value() )
-                            continue;
-
-                        auto & space = game.get( s.value() );
-                        if ( space.piece ) {
-                            blocked = 1;
-                            break;
-                        }
-                    }
-
-                    if ( !blocked ) {
-                        score += 1;
-                    }
-                }
-            }
+        float castling_score = 0.0f;
+        if ( game.can_castle( white ) ) {
+            castling_score += 1;
         }
-
-        return score;
-    }
-    float ai_controller::compute_bishop_pair_score( const chess_game & game, const bool white ) const
-    {
-        int bishop_count = 0;
-        for ( int i = 1; i <= 8; i++ ) {
-            for ( int j = 1; j <= 8; j++ ) {
-                auto & space = game.get( pieces::piece::itopos( i, j ).value() );
-
-                if ( !space.piece )
-                    continue;
-
-                if ( space.piece->colour() && space.piece->colour() == white ) {
-                    switch ( space.piece->type() ) {
-                    case pieces::name_t::bishop:
-                        bishop_count++;
-                        break;
-                    default:
-                        break;
-                    }
+        else {
+            auto const & move_history = game.get_move_history();
+            if ( move_history.size() > 2 ) {
+                auto const & second_last = move_history[move_history.size() - 2];
+                if ( second_last == "O-O" || second_last == "O-O-O" ) {
+                    castling_score += 2;
                 }
             }
         }
+        features[castling_term] = castling_score;
 
-        return bishop_count > 1;
-    }
-    float ai_controller::compute_king_centralization_score( const chess_game & game, const bool white ) const
-    {
-        float              score = 0.0f;
-        pieces::position_t king_position;
+        auto pawn_starting_rank      = white ? game::rank_1_bb << 8 : game::rank_8_bb >> 8;
+        auto piece_starting_rank     = white ? game::rank_1_bb : game::rank_8_bb;
+        auto development_speed_score = 0.5f * game::popcount( own_pawns & ~pawn_starting_rank ) +
+                                       game::popcount( own & ~own_pawns & ~piece_starting_rank );
+        features[development_term] = development_speed_score;
 
-        if ( white ) {
-            king_position = game.white_king.get().position();
-        }
-        else {
-            king_position = game.black_king.get().position();
-        }
+        float doubled_pawn_score = pawn_info.doubled[white];
+        features[doubled_pawn_term] = doubled_pawn_score;
 
-        int king_rank = static_cast< int >( king_position.first );
-        int king_file = static_cast< int >( king_position.second );
+        float isolated_pawn_score = pawn_info.isolated[white];
+        features[isolated_pawn_term] = isolated_pawn_score;
 
-        std::vector< std::pair< int, int > > center_squares = { { 4, 4 }, { 5, 4 }, { 4, 5 }, { 5, 5 } };
+        // own pieces on the squares diagonally in front of each pawn
+        auto connected_pawn_score = static_cast< float >( game::popcount( pawn_info.west[white] & own ) +
+                                                          game::popcount( pawn_info.east[white] & own ) );
+        features[connected_pawn_term] = connected_pawn_score;
 
-        int min_distance = 8;  // Max number of moves across the board for the king cannot be more than 8
-        for ( const auto & [cf, cr] : center_squares ) {
-            int distance = std::max( std::abs( king_file - cf ), std::abs( king_rank - cr ) );
-            min_distance = std::min( distance, min_distance );
-        }
+        float passed_pawn_score = pawn_info.passed[white];
+        features[passed_pawn_term] = passed_pawn_score;
 
-        int centralization_score = -min_distance;
+        float enemy_king_pressure_score = king_pressure( !white );
+        features[enemy_king_pressure_term] = enemy_king_pressure_score;
 
-        int distance_from_opposite_side;
-        if ( white ) {
-            distance_from_opposite_side = 7 - king_rank;
-        }
-        else {
-            distance_from_opposite_side = king_rank;
-        }
-
-        score = centralization_score - distance_from_opposite_side * 0.25;
-
-        return score;
-    }
-    float ai_controller::compute_knight_outpost_score( const chess_game & game, const bool white ) const
-    {
-        float                      score = 0.0f;
-        std::vector< game::space > knights;
+        auto piece_defense_score = static_cast< float >( game::popcount( own & attacked[white] ) );
+        features[piece_defense_term] = piece_defense_score;
 
-        for ( int i = 1; i <= 8; i++ ) {
-            for ( int j = 1; j <= 8; j++ ) {
-                auto & space = game.get( pieces::piece::itopos( i, j ).value() );
+        // only white's pair has ever been counted, the tuned weights expect that
+        float bishop_pair_score = white && material_info.bishop_pair[white];
+        features[bishop_pair_term] = bishop_pair_score;
 
-                if ( space.piece && space.piece->colour() == white && space.piece->type() == pieces::name_t::knight ) {
-                    knights.push_back( space );
-                }
-            }
+        // each pair of rooks that see each other along a rank or file counts once
+        float connected_rooks_score = 0.0f;
+        for ( auto rooks = game.piece_set( pieces::name_t::rook, white ); rooks; ) {
+            connected_rooks_score += game::popcount( game::rook_attacks( game::pop_lsb( rooks ), occupied ) & rooks );
         }
+        features[connected_rooks_term] = connected_rooks_score;
 
-        for ( int i = 0; i < knights.size(); i++ ) {
-            int knight_rank = static_cast< int >( knights[i].position().first );
-            if ( ( white && knight_rank <= 4 ) || ( !white && knight_rank >= 5 ) ) {
-                continue;
-            }
+        // king centralization is not scored, king_centralization_val has no effect
+        features[king_centralization_term] = 0.0f;
 
-            // check if a friendly pawn is defending the knight
-            int  defended_by_pawn = 0;
-            auto defenders        = game.find_attackers( knights[i], !white );
-            for ( auto defender : defenders ) {
-                if ( defender.piece->type() == pieces::name_t::pawn ) {
-                    defended_by_pawn = 1;
-                }
-            }
+        // knights in the enemy half defended by a pawn and out of reach of the enemy pawns
+        auto enemy_half           = white ? ~game::empty_bb << 32 : ~game::empty_bb >> 32;
+        auto defended             = pawn_info.west[white] | pawn_info.east[white];
+        auto attacked_by_pawns    = pawn_info.west[!white] | pawn_info.east[!white];
+        auto knight_outpost_score = static_cast< float >( game::popcount(
+            game.piece_set( pieces::name_t::knight, white ) & enemy_half & defended & ~attacked_by_pawns ) );
+        features[knight_outpost_term] = knight_outpost_score;
 
-            if ( !defended_by_pawn ) {
-                continue;
-            }
+        // knights, bishops, rooks and queens without a legal move
+        auto officers            = own & ~own_pawns & ~game.piece_set( pieces::name_t::king, white );
+        auto blocked_piece_score = static_cast< float >( game::popcount( officers & ~movable ) );
+        features[blocked_piece_term] = blocked_piece_score;
 
-            // check if being attacked by enemy pawn
-            int  attacked_by_enemy_pawn = 0;
-            auto attackers              = game.find_attackers( knights[i], white );
+        // ranks 4 to 8 for white, 1 to 4 for black
+        auto half                = white ? ~game::empty_bb << 24 : ~game::empty_bb >> 32;
+        auto space_control_score = static_cast< float >( game::popcount( half & attacked[white] ) );
+        features[space_control_term] = space_control_score;
 
-            for ( auto attacker : attackers ) {
-                if ( attacker.piece->type() == pieces::name_t::pawn ) {
-                    attacked_by_enemy_pawn = 1;
-                }
-            }
+        float king_shield_score = 0.0f;
+        auto  king              = game.king_square( white );
+        if ( king != game::num_squares ) {
+            int forward_rank = game::rank_of( king ) + ( white ? 1 : -1 );
+            if ( forward_rank >= 1 && forward_rank <= 8 ) {
+                // pieces and pawns of either colour count, on light squares for white and dark squares for black, as
+                // the weights were tuned with
+                constexpr game::bitboard_t light_squares = 0x55AA55AA55AA55AAULL;
 
-            if ( attacked_by_enemy_pawn ) {
-                continue;
+                auto pawns  = own_pawns | enemy_pawns;
+                auto shield = game::king_attacks[king] & ( game::rank_1_bb << ( 8 * ( forward_rank - 1 ) ) ) &
+                              ( white ? light_squares : ~light_squares ) & occupied;
+                king_shield_score += game::popcount( shield & pawns ) + 2 * game::popcount( shield & ~pawns );
             }
-
-            score += 1;
         }
+        features[king_shield_term] = king_shield_score;
 
-        return score;
-    }
-    float ai_controller::compute_blocked_piece_score( const chess_game & game, const bool white ) const
-    {
-        float score = 0.0f;
-
-        std::vector< game::space > possible_moves;
-        for ( int i = 1; i <= 8; i++ ) {
-            for ( int j = 1; j <= 8; j++ ) {
-                auto & space = game.get( pieces::piece::itopos( i, j ).value() );
-
-                if ( space.piece && space.piece->colour() == white ) {
-                    switch ( space.piece->type() ) {
-                    case pieces::name_t::bishop:
-                    case pieces::name_t::knight:
-                    case pieces::name_t::rook:
-                    case pieces::name_t::queen:
-                        game.possible_moves( space, possible_moves );
-                        if ( possible_moves.size() == 0 ) {
-                            score += 1;
-                        }
-
-                        possible_moves.clear();
-                        break;
-                    default:
-                        continue;
-                    }
-                }
-            }
-        }
-        return score;
+        float king_pressure_score = -king_pressure( white );
+        features[king_pressure_term] = king_pressure_score;
+
+        // the position weights count towards white like the material does
+        float piece_square_score    = position_score( game );
+        features[piece_square_term] = white ? piece_square_score : -piece_square_score;
     }
-    float ai_controller::compute_space_control_score( const chess_game & game, const bool white ) const
+
+    float ai_controller::move_score( const chess_game & game, const move_t move ) const
     {
-        float                      score = 0.0f;
-        std::vector< game::space > spaces;
-        if ( white ) {
-            for ( int i = 4; i <= 8; i++ ) {
-                for ( int j = 1; j <= 8; j++ ) {
-                    auto & space = game.get( pieces::piece::itopos( i, j ).value() );
-                    spaces.push_back( space );
-                }
-            }
-        }
-        else {
-            for ( int i = 1; i <= 4; i++ ) {
-                for ( int j = 1; j <= 8; j++ ) {
-                    auto & space = game.get( pieces::piece::itopos( i, j ).value() );
-                    spaces.push_back( space );
-                }
-            }
+        if ( game.piece_on( move.to() ) == game::no_piece && move.flag() != game::move_flag::promotion ) {
+            return 0.0f;
         }
 
-        chess_game::attack_map game_attack_map = game.game_attack_map;
-        for ( auto space : spaces ) {
-            if ( game_attack_map.has_attackers( space, white ) ) {
-                score += 1;
-            }
-            // auto attackers = game.find_attackers( space, !white );
-            // if ( attackers.size() != 0 ) {
-            //     score += 1;
-            // }
-        }
-        return score;
+        return static_cast< float >( game.see( move ) );
     }
-    float ai_controller::compute_king_shield_score( const chess_game & game, const bool white ) const
+
+    // winning captures first, then quiet moves and even trades, losing captures last
+    std::size_t ai_controller::order_moves( const chess_game & game, game::move_list & moves ) const
     {
-        float              score = 0.0f;
-        pieces::position_t king_position;
-        if ( white ) {
-            king_position = game.white_king.get().position();
-        }
-        else {
-            king_position = game.black_king.get().position();
+        std::array< float, game::move_list::capacity > scores;
+        for ( std::size_t i = 0; i < moves.size(); i++ ) {
+            scores[i] = move_score( game, moves[i] );
         }
 
-        int king_rank = static_cast< int >( king_position.first );
-        int king_file = static_cast< int >( king_position.second );
-
-        int forward_rank;
-        if ( white ) {
-            forward_rank = king_rank + 1;
-        }
-        else {
-            forward_rank = king_rank - 1;
-        }
+        // insertion sort, equal moves keep their generation order
+        for ( std::size_t i = 1; i < moves.size(); i++ ) {
+            auto        move  = moves[i];
+            float       score = scores[i];
+            std::size_t j     = i;
 
-        for ( int i = king_file - 1; i <= king_file + 1; i++ ) {
-            if ( 1 <= i && i <= 8 ) {
-                auto & space = game.get( pieces::piece::itopos( forward_rank, i ).value() );
-                if ( space.piece && space.colour() == white ) {
-                    if ( space.piece->type() == pieces::name_t::pawn ) {
-                        score += 1;
-                    }
-                    else {
-                        score += 2;
-                    }
-                }
+            for ( ; j > 0 && scores[j - 1] < score; j-- ) {
+                moves[j]  = moves[j - 1];
+                scores[j] = scores[j - 1];
             }
-        }
-
-        return score;
-    }
-    float ai_controller::position_score( const chess_game & game ) const
-    {
-        float score = 0.f;
 
-        for ( int i = 1; i <= 8; ++i ) {
-            for ( int j = 1; j <= 8; ++j ) {
-                auto & sp = game.get( pieces::piece::itopos( i, j ).value() );
-
-                if ( !sp.piece )
-                    continue;  // skip empty squares
-
-                bool is_white = sp.piece->colour();
-                int  row      = i - 1;
-                int  col      = j - 1;
-
-                // For black pieces, mirror vertically
-                if ( !is_white ) {
-                    auto [mi, mj] = mirror_vertically( sp.position() );
-                    row           = static_cast< int >( mi ) - 1;
-                    col           = static_cast< int >( mj ) - 1;
-                }
-
-                float value = 0.0f;
-
-                switch ( sp.piece->type() ) {
-                case pieces::name_t::pawn:
-                    value = chromosome.pawn_position_weights[row][col];
-                    break;
-                case pieces::name_t::knight:
-                    value = chromosome.knight_position_weights[row][col];
-                    break;
-                case pieces::name_t::bishop:
-                    value = chromosome.bishop_position_weights[row][col];
-                    break;
-                case pieces::name_t::rook:
-                    value = chromosome.rook_position_weights[row][col];
-                    break;
-                case pieces::name_t::queen:
-                    value = chromosome.queen_position_weights[row][col];
-                    break;
-                default:
-                    break;  // skip kings or unknowns
-                }
-
-                if ( is_white ) {
-                    score += value;
-                }
-                else {
-                    score -= value;
-                }
-            }
+            moves[j]  = move;
+            scores[j] = score;
         }
-        return score;
-    }
-    float ai_controller::evaluate_position( const chess_game & game, const bool white ) const
-    {
-        chess_game game_copy = game;
-        game_copy.set_turn( white );
 
-        if (game.checkmate(false)) {
-            return 1000;
+        std::size_t safe = 0;
+        while ( safe < moves.size() && scores[safe] >= 0.0f ) {
+            safe++;
         }
-
-        float                                          score = 0;
-        std::chrono::high_resolution_clock::time_point start, end;
-        std::chrono::microseconds                      duration;
-
-        // std::cout << chromosome.king_centralization_val << std::endl;
-        // exit(1);
-
-        start                = std::chrono::high_resolution_clock::now();
-        float material_score = compute_material_score( game_copy, white );
-        end                  = std::chrono::high_resolution_clock::now();
-        duration             = std::chrono::duration_cast< std::chrono::microseconds >( end - start );
-        score += material_score * chromosome.material_score_bonus;
-        // std::cout << "material_score_time " << duration.count() << " microseconds\n";
-        // std::cout << "\t\tmaterial_score: " << material_score << std::endl;
-
-        start                      = std::chrono::high_resolution_clock::now();
-        float piece_mobility_score = compute_piece_mobility( game_copy, white );
-        end                        = std::chrono::high_resolution_clock::now();
-        duration                   = std::chrono::duration_cast< std::chrono::microseconds >( end - start );
-        score += piece_mobility_score * chromosome.piece_mobility_bonus;
-        // std::cout << "piece_mobility_score " << duration.count() << " microseconds\n";
-        // std::cout << "\t\tpiece_mobility_score: " << piece_mobility_score << std::endl;
-
-        start                = std::chrono::high_resolution_clock::now();
-        float castling_score = compute_castling_bonus( game_copy, white );
-        end                  = std::chrono::high_resolution_clock::now();
-        duration             = std::chrono::duration_cast< std::chrono::microseconds >( end - start );
-        score += castling_score * chromosome.castling_bonus;
-        // std::cout << "castling_score " << duration.count() << " microseconds\n";
-        // std::cout << "\t\tcastling_score: " << castling_score << std::endl;
-
-        start                         = std::chrono::high_resolution_clock::now();
-        float development_speed_score = compute_development_speed( game_copy, white );
-        end                           = std::chrono::high_resolution_clock::now();
-        duration                      = std::chrono::duration_cast< std::chrono::microseconds >( end - start );
-        score += development_speed_score * chromosome.development_speed_bonus;
-        // std::cout << "development_speed_score " << duration.count() << " microseconds\n";
-        // std::cout << "\t\tdevelopment_speed_score: " << development_speed_score << std::endl;
-
-        start                    = std::chrono::high_resolution_clock::now();
-        float doubled_pawn_score = compute_doubled_pawn_score( game_copy, white );
-        end                      = std::chrono::high_resolution_clock::now();
-        duration                 = std::chrono::duration_cast< std::chrono::microseconds >( end - start );
-        score += doubled_pawn_score * chromosome.doubled_pawn_penalty;
-        // std::cout << "doubled_pawn_score " << duration.count() << " microseconds\n";
-        // std::cout << "\t\tdoubled_pawn_score: " << doubled_pawn_score << std::endl;
-
-        start                     = std::chrono::high_resolution_clock::now();
-        float isolated_pawn_score = compute_isolated_pawn_score( game_copy, white );
-        end                       = std::chrono::high_resolution_clock::now();
-        duration                  = std::chrono::duration_cast< std::chrono::microseconds >( end - start );
-        score += isolated_pawn_score * chromosome.isolated_pawn_penalty;
-        // std::cout << "isolated_pawn_score " << duration.count() << " microseconds\n";
-        // std::cout << "\t\tisolated_pawn_score: " << isolated_pawn_score << std::endl;
-
-        start                      = std::chrono::high_resolution_clock::now();
-        float connected_pawn_score = compute_connected_pawn_score( game_copy, white );
-        end                        = std::chrono::high_resolution_clock::now();
-        duration                   = std::chrono::duration_cast< std::chrono::microseconds >( end - start );
-        score += connected_pawn_score * chromosome.connected_pawn_bonus;
-        // std::cout << "connected_pawn_score " << duration.count() << " microseconds\n";
-        // std::cout << "\t\tconnected_pawn_score: " << connected_pawn_score << std::endl;
-
-        start                   = std::chrono::high_resolution_clock::now();
-        float passed_pawn_score = compute_passed_pawn_score( game_copy, white );
-        end                     = std::chrono::high_resolution_clock::now();
-        duration                = std::chrono::duration_cast< std::chrono::microseconds >( end - start );
-        score += passed_pawn_score * chromosome.passed_pawn_bonus;
-        // std::cout << "passed_pawn_score " << duration.count() << " microseconds\n";
-        // std::cout << "\t\tpassed_pawn_score: " << passed_pawn_score << std::endl;
-
-        start                           = std::chrono::high_resolution_clock::now();
-        float enemy_king_pressure_score = compute_king_pressure_score( game_copy, not white );
-        end                             = std::chrono::high_resolution_clock::now();
-        duration                        = std::chrono::duration_cast< std::chrono::microseconds >( end - start );
-        score += enemy_king_pressure_score * chromosome.enemy_king_pressure_bonus;
-        // std::cout << "enemy_king_pressure_score " << duration.count() << " microseconds\n";
-        // std::cout << "\t\tenemy_king_pressure_score: " << enemy_king_pressure_score << std::endl;
-
-        start                     = std::chrono::high_resolution_clock::now();
-        float piece_defense_score = compute_piece_defense_score( game_copy, white );
-        end                       = std::chrono::high_resolution_clock::now();
-        duration                  = std::chrono::duration_cast< std::chrono::microseconds >( end - start );
-        score += piece_defense_score * chromosome.piece_defense_bonus;
-        // std::cout << "piece_defense_score " << duration.count() << " microseconds\n";
-        // std::cout << "\t\tpiece_defense_score: " << piece_defense_score << std::endl;
-
-        start                   = std::chrono::high_resolution_clock::now();
-        float bishop_pair_score = compute_bishop_pair_score( game_copy, white );
-        end                     = std::chrono::high_resolution_clock::now();
-        duration                = std::chrono::duration_cast< std::chrono::microseconds >( end - start );
-        score += bishop_pair_score * chromosome.bishop_pair_bonus;
-        // std::cout << "bishop_pair_score " << duration.count() << " microseconds\n";
-        // std::cout << "\t\tbishop_pair_score: " << bishop_pair_score << std::endl;
-
-        start                       = std::chrono::high_resolution_clock::now();
-        float connected_rooks_score = compute_connected_rooks_score( game_copy, white );
-        end                         = std::chrono::high_resolution_clock::now();
-        duration                    = std::chrono::duration_cast< std::chrono::microseconds >( end - start );
-        score += connected_rooks_score * chromosome.connected_rooks_bonus;
-        // std::cout << "connected_rooks_score " << duration.count() << " microseconds\n";
-        // std::cout << "\t\tconnected_rooks_score: " << connected_rooks_score << std::endl;
-
-        start                           = std::chrono::high_resolution_clock::now();
-        float king_centralization_score = compute_king_centralization_score( game_copy, white );
-        end                             = std::chrono::high_resolution_clock::now();
-        duration                        = std::chrono::duration_cast< std::chrono::microseconds >( end - start );
-        // score += king_centralization_score * chromosome.king_centralization_val;
-        // std::cout << "king_centralization_score " << duration.count() << " microseconds\n";
-        // std::cout << "\t\tking_centralization_score: " << king_centralization_score << std::endl;
-
-        start                      = std::chrono::high_resolution_clock::now();
-        float knight_outpost_score = compute_knight_outpost_score( game_copy, white );
-        end                        = std::chrono::high_resolution_clock::now();
-        duration                   = std::chrono::duration_cast< std::chrono::microseconds >( end - start );
-        score += knight_outpost_score * chromosome.knight_outpost_bonus;
-        // std::cout << "knight_outpost_score " << duration.count() << " microseconds\n";
-        // std::cout << "\t\tknight_outpost_score: " << knight_outpost_score << std::endl;
-
-        start                     = std::chrono::high_resolution_clock::now();
-        float blocked_piece_score = compute_blocked_piece_score( game_copy, white );
-        end                       = std::chrono::high_resolution_clock::now();
-        duration                  = std::chrono::duration_cast< std::chrono::microseconds >( end - start );
-        score += blocked_piece_score * chromosome.blocked_piece_penalty;
-        // std::cout << "blocked_piece_score " << duration.count() << " microseconds\n";
-        // std::cout << "\t\tblocked_piece_score: " << blocked_piece_score << std::endl;
-
-        start                     = std::chrono::high_resolution_clock::now();
-        float space_control_score = compute_space_control_score( game_copy, white );
-        end                       = std::chrono::high_resolution_clock::now();
-        duration                  = std::chrono::duration_cast< std::chrono::microseconds >( end - start );
-        score += space_control_score * chromosome.space_control_in_opponent_half_bonus;
-        // std::cout << "space_control_score " << duration.count() << " microseconds\n";
-        // std::cout << "\t\tspace_control_score: " << space_control_score << std::endl;
-
-        start                   = std::chrono::high_resolution_clock::now();
-        float king_shield_score = compute_king_shield_score( game_copy, white );
-        end                     = std::chrono::high_resolution_clock::now();
-        duration                = std::chrono::duration_cast< std::chrono::microseconds >( end - start );
-        score += king_shield_score * chromosome.king_shield_bonus;
-        // std::cout << "king_shield_score " << duration.count() << " microseconds\n";
-        // std::cout << "\t\tking_shield_score: " << king_shield_score << std::endl;
-
-        start                     = std::chrono::high_resolution_clock::now();
-        float king_pressure_score = -compute_king_pressure_score( game_copy, white );
-        end                       = std::chrono::high_resolution_clock::now();
-        duration                  = std::chrono::duration_cast< std::chrono::microseconds >( end - start );
-        score += king_pressure_score * chromosome.king_pressure_penalty;
-        // std::cout << "king_pressure_score " << duration.count() << " microseconds\n";
-        // std::cout << "\t\tking_pressure_score: " << king_pressure_score << std::endl;
-
-        start                 = std::chrono::high_resolution_clock::now();
-        float position_scores = position_score( game_copy );
-        // std::cout << "position_scores: " << position_scores;
-        end      = std::chrono::high_resolution_clock::now();
-        duration = std::chrono::duration_cast< std::chrono::microseconds >( end - start );
-        //score -= position_scores;
-        // std::cout << "position_scores " << duration.count() << " microseconds\n\n\n";
-        // exit( 1 );
-        // std::cout << "\t\tfinal score: " << score << std::endl << std::endl;
-        return score;
+        return safe;
     }
 
     float ai_controller::minimax( chess_game & game, const int depth, float alpha, float beta,
                               bool white_to_move ) const
     {
-        uint64_t zobrist_key = compute_zobrist_hash( game.get_board() );
+        // a repeated position or one past the fifty move rule is a draw, it is not cached as that depends on the
+        // moves that led to it
+        if ( game.is_repetition() || game.fifty_move_rule() ) {
+            return 0.0f;
+        }
+
+        game::zobrist_key_t zobrist_key = game.hash();
 
         // Thread-safe cache lookup
         {
@@ -1009,18 +476,26 @@ namespace chess::controller {
             return score;
         }
 
-        std::vector< move_t > legal_moves = game.legal_moves();
-        
+        // only the captures need scoring, the quiet moves go in after the ones that win or trade evenly
+        game::move_list legal_moves;
+        game.generate< game::gen_type::captures >( legal_moves );
+
+        auto safe     = order_moves( game, legal_moves );
+        auto captures = legal_moves.size();
+
+        game.generate< game::gen_type::quiets >( legal_moves );
+        std::rotate( legal_moves.begin() + safe, legal_moves.begin() + captures, legal_moves.end() );
+
         if ( white_to_move ) {
             // White maximizes (wants higher scores)
             float max_eval = -std::numeric_limits< float >::infinity();
 
-            for ( const move_t & move : legal_moves ) {
-                chess_game possible_move = game;
-                possible_move.move( move.first, move.second );
+            for ( move_t const move : legal_moves ) {
+                game.make_move( move );
 
                 // After White's move, it's Black's turn
-                float score = minimax( possible_move, depth - 1, alpha, beta, false );
+                float score = minimax( game, depth - 1, alpha, beta, false );
+                game.unmake_move();
 
                 max_eval = std::max( max_eval, score );
                 alpha = std::max( alpha, score );
@@ -1040,12 +515,12 @@ namespace chess::controller {
             // Black minimizes (wants lower scores from White's perspective)
             float min_eval = std::numeric_limits< float >::infinity();
 
-            for ( const move_t & move : legal_moves ) {
-                chess_game possible_move = game;
-                possible_move.move( move.first, move.second );
-                
+            for ( move_t const move : legal_moves ) {
+                game.make_move( move );
+
                 // After Black's move, it's White's turn
-                float score = minimax( possible_move, depth - 1, alpha, beta, true );
+                float score = minimax( game, depth - 1, alpha, beta, true );
+                game.unmake_move();
 
                 min_eval = std::min( min_eval, score );
                 beta = std::min( beta, score );
@@ -1065,7 +540,7 @@ namespace chess::controller {
 
     move_t ai_controller::select_best_move( const int depth ) const
     {
-        std::vector< move_t > legal_moves = game.legal_moves();
+        game::move_list legal_moves = game.legal_moves();
 
         if ( legal_moves.empty() ) {
             throw std::runtime_error( "No Legal Moves" );
@@ -1074,11 +549,13 @@ namespace chess::controller {
         bool is_white_turn = game.white_move();
 
         std::vector<std::future<std::pair<move_t, float>>> futures;
-        for (const move_t& move : legal_moves) {
+        for (move_t const move : legal_moves) {
             futures.push_back(std::async(std::launch::async, [this, move, depth, is_white_turn]() {
+                // one copy per thread, the search then runs in place on it
                 chess_game possible_move = game;
-                possible_move.move(move.first, move.second);
-                
+                possible_move.set_piece_square_table( &piece_squares );
+                possible_move.make_move(move);
+
                 float score = minimax(possible_move, depth - 1, 
                                     -std::numeric_limits<double>::infinity(),
                                     std::numeric_limits<double>::infinity(), 
@@ -1097,8 +574,8 @@ namespace chess::controller {
         for (auto& future : futures) {
             auto [move, score] = future.get();
             
-            std::cout << pieces::to_string(move.first.position()) << " to " 
-                    << pieces::to_string(move.second.position()) 
+            std::cout << pieces::to_string(game::to_position(move.from())) << " to " 
+                    << pieces::to_string(game::to_position(move.to())) 
                     << " score: " << score << std::endl;
             
             if ((is_white_turn && score > best_score) || 
@@ -1138,13 +615,15 @@ namespace chess::controller {
             end                = std::chrono::high_resolution_clock::now();
             duration           = std::chrono::duration_cast< std::chrono::milliseconds >( end - start );
 
-            std::cout << "AI selected move: " << to_string( selected_move.first.position() ) << " to "
-                      << to_string( selected_move.second.position() ) << " in " << duration.count()
-                      << " milliseconds\n";
+            auto src = game::to_position( selected_move.from() );
+            auto dst = game::to_position( selected_move.to() );
+
+            std::cout << "AI selected move: " << to_string( src ) << " to " << to_string( dst ) << " in "
+                      << duration.count() << " milliseconds\n";
 
-            select_space( selected_move.first.position() );
+            select_space( src );
 
-            if ( move( selected_move.second ) != pieces::move_status::valid ) {
+            if ( move( game.get( dst ) ) != pieces::move_status::valid ) {
                 std::cout << "Error: AI Selected Invalid move_t, AI Offline\n";
                 return;
             }
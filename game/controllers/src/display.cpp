@@ -54,7 +54,7 @@ namespace chess::controller {
             throw std::runtime_error( "Invalid Coordinates Given to itopos" );
 
         std::lock_guard game_guard( game_mutex );
-        auto &          sp = game.get( *pos );
+        auto            sp = game.get( *pos );
 
         bool possible = false;
         if ( std::find( possible_moves.begin(), possible_moves.end(), sp ) != possible_moves.end() ) {
@@ -111,8 +111,7 @@ namespace chess::controller {
 
     void server_controller::possible_moves_handler( std::string const & move )
     {
-        std::vector< game::space > possible_moves;
-        possible_moves.reserve( 64 );
+        game::move_list possible_moves;
 
         try {
             {
@@ -121,8 +120,8 @@ namespace chess::controller {
             }
 
             std::stringstream ss;
-            for ( auto & sp : possible_moves ) {
-                ss << to_string( sp.position() );
+            for ( auto const & m : possible_moves ) {
+                ss << to_string( game::to_position( m.to() ) );
             }
 
             server.write( networking::possible_moves_command + ss.str() );
@@ -0,0 +1,175 @@
+#ifndef __CHESS__GAME__ATTACKS__
+#define __CHESS__GAME__ATTACKS__
+
+#include <array>
+#include <bitboard.hpp>
+
+#if defined( __BMI2__ )
+#include <immintrin.h>
+#endif
+
+namespace chess::game {
+
+    using attack_table_t = std::array< bitboard_t, num_squares >;
+
+    // the square one step of (rank_step, file_step) away from sq, or nothing if that is off the board
+    constexpr bitboard_t step_bb( square_t const sq, int const rank_step, int const file_step )
+    {
+        int rank = rank_of( sq ) + rank_step;
+        int file = file_of( sq ) + file_step;
+
+        if ( rank < 1 || rank > 8 || file < 1 || file > 8 ) {
+            return empty_bb;
+        }
+
+        return square_bb( make_square( rank, file ) );
+    }
+
+    constexpr attack_table_t make_knight_attacks()
+    {
+        attack_table_t table{};
+        for ( square_t sq = 0; sq < num_squares; sq++ ) {
+            table[sq] = step_bb( sq, 1, 2 ) | step_bb( sq, 2, 1 ) | step_bb( sq, -1, 2 ) | step_bb( sq, -2, 1 ) |
+                        step_bb( sq, 1, -2 ) | step_bb( sq, 2, -1 ) | step_bb( sq, -1, -2 ) | step_bb( sq, -2, -1 );
+        }
+        return table;
+    }
+
+    constexpr attack_table_t make_king_attacks()
+    {
+        attack_table_t table{};
+        for ( square_t sq = 0; sq < num_squares; sq++ ) {
+            table[sq] = step_bb( sq, 1, -1 ) | step_bb( sq, 1, 0 ) | step_bb( sq, 1, 1 ) | step_bb( sq, 0, -1 ) |
+                        step_bb( sq, 0, 1 ) | step_bb( sq, -1, -1 ) | step_bb( sq, -1, 0 ) | step_bb( sq, -1, 1 );
+        }
+        return table;
+    }
+
+    constexpr attack_table_t make_pawn_attacks( bool const white )
+    {
+        int            forward = white ? 1 : -1;
+        attack_table_t table{};
+        for ( square_t sq = 0; sq < num_squares; sq++ ) {
+            table[sq] = step_bb( sq, forward, -1 ) | step_bb( sq, forward, 1 );
+        }
+        return table;
+    }
+
+    // squares attacked by a knight or king standing on a square
+    inline constexpr attack_table_t knight_attacks = make_knight_attacks();
+    inline constexpr attack_table_t king_attacks   = make_king_attacks();
+
+    // squares attacked by a pawn standing on a square, indexed by colour first (1 is white)
+    inline constexpr std::array< attack_table_t, 2 > pawn_attacks = { make_pawn_attacks( false ),
+                                                                      make_pawn_attacks( true ) };
+
+    using square_table_t = std::array< attack_table_t, num_squares >;
+
+    // every square from sq in the direction (rank_step, file_step) up to the edge of the board
+    constexpr bitboard_t direction_bb( square_t const sq, int const rank_step, int const file_step )
+    {
+        bitboard_t targets = empty_bb;
+        for ( bitboard_t next = step_bb( sq, rank_step, file_step ); next;
+              next            = step_bb( lsb( next ), rank_step, file_step ) ) {
+            targets |= next;
+        }
+        return targets;
+    }
+
+    inline constexpr int slider_directions[8][2] = { { 1, 0 },  { -1, 0 }, { 0, 1 },  { 0, -1 },
+                                                     { 1, 1 },  { 1, -1 }, { -1, 1 }, { -1, -1 } };
+
+    constexpr square_table_t make_between_table()
+    {
+        square_table_t table{};
+        for ( square_t sq = 0; sq < num_squares; sq++ ) {
+            for ( auto const & [rank_step, file_step] : slider_directions ) {
+                bitboard_t path = empty_bb;
+                for ( bitboard_t next = step_bb( sq, rank_step, file_step ); next;
+                      next            = step_bb( lsb( next ), rank_step, file_step ) ) {
+                    table[sq][lsb( next )] = path;
+                    path |= next;
+                }
+            }
+        }
+        return table;
+    }
+
+    constexpr square_table_t make_line_table()
+    {
+        square_table_t table{};
+        for ( square_t sq = 0; sq < num_squares; sq++ ) {
+            for ( auto const & [rank_step, file_step] : slider_directions ) {
+                bitboard_t line = direction_bb( sq, rank_step, file_step ) |
+                                  direction_bb( sq, -rank_step, -file_step ) | square_bb( sq );
+
+                for ( bitboard_t targets = direction_bb( sq, rank_step, file_step ); targets; ) {
+                    table[sq][pop_lsb( targets )] = line;
+                }
+            }
+        }
+        return table;
+    }
+
+    // squares strictly between two squares sharing a rank, file or diagonal, empty if they share none
+    inline constexpr square_table_t between_bb = make_between_table();
+
+    // the whole rank, file or diagonal through two squares, empty if they share none
+    inline constexpr square_table_t line_bb = make_line_table();
+
+    // occupancy lookup for one slider on one square
+    struct magic_t {
+        bitboard_t   mask;     // squares whose occupancy matters, the edges of each ray are left out
+        bitboard_t   magic;    // maps every subset of mask to a unique index, see attacks.cpp
+        bitboard_t * attacks;  // this square's slice of the shared attack table
+        unsigned     shift;
+
+        unsigned index( bitboard_t const occupied ) const
+        {
+#if defined( __BMI2__ )
+            return static_cast< unsigned >( _pext_u64( occupied, mask ) );
+#else
+            return static_cast< unsigned >( ( ( occupied & mask ) * magic ) >> shift );
+#endif
+        }
+    };
+
+    struct slider_tables_t {
+        static constexpr std::size_t bishop_table_size = 5248;
+        static constexpr std::size_t rook_table_size   = 102400;
+
+        magic_t bishop[num_squares];
+        magic_t rook[num_squares];
+
+        std::array< bitboard_t, bishop_table_size + rook_table_size > table;
+
+        slider_tables_t();
+    };
+
+    // built on first use so that positions created during static initialisation can already use them
+    inline slider_tables_t const & slider_tables()
+    {
+        static slider_tables_t const tables;
+        return tables;
+    }
+
+    // squares attacked by a slider on sq, up to and including the first blocker in each direction
+    inline bitboard_t bishop_attacks( square_t const sq, bitboard_t const occupied )
+    {
+        auto const & entry = slider_tables().bishop[sq];
+        return entry.attacks[entry.index( occupied )];
+    }
+
+    inline bitboard_t rook_attacks( square_t const sq, bitboard_t const occupied )
+    {
+        auto const & entry = slider_tables().rook[sq];
+        return entry.attacks[entry.index( occupied )];
+    }
+
+    inline bitboard_t queen_attacks( square_t const sq, bitboard_t const occupied )
+    {
+        return bishop_attacks( sq, occupied ) | rook_attacks( sq, occupied );
+    }
+}  // namespace chess::game
+
+#endif
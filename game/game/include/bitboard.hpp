@@ -0,0 +1,125 @@
+#ifndef __CHESS__GAME__BITBOARD__
+#define __CHESS__GAME__BITBOARD__
+
+#include <bit>
+#include <cstdint>
+#include <piece.hpp>
+
+namespace chess::game {
+
+    // one bit per square, bit 0 is A1, bit 7 is H1, bit 63 is H8
+    using bitboard_t = std::uint64_t;
+
+    // index of a square in a bitboard, 0 (A1) to 63 (H8)
+    using square_t = int;
+
+    constexpr int num_squares = 64;
+
+    // index of a coloured piece type, the order is shared with the zobrist tables
+    enum piece_index : std::uint8_t {
+        white_pawn,
+        white_knight,
+        white_bishop,
+        white_rook,
+        white_queen,
+        white_king,
+        black_pawn,
+        black_knight,
+        black_bishop,
+        black_rook,
+        black_queen,
+        black_king,
+        no_piece,
+    };
+
+    constexpr int num_piece_indices = 12;
+
+    constexpr bitboard_t empty_bb = 0ULL;
+
+    constexpr bitboard_t file_a_bb = 0x0101010101010101ULL;
+    constexpr bitboard_t file_h_bb = file_a_bb << 7;
+    constexpr bitboard_t rank_1_bb = 0xFFULL;
+    constexpr bitboard_t rank_8_bb = rank_1_bb << 56;
+
+    constexpr bitboard_t square_bb( square_t const sq ) { return 1ULL << sq; }
+
+    constexpr square_t make_square( int const rank, int const file ) { return ( rank - 1 ) * 8 + ( file - 1 ); }
+
+    // rank and file of a square, 1 based like pieces::rank_t and pieces::file_t
+    constexpr int rank_of( square_t const sq ) { return ( sq >> 3 ) + 1; }
+    constexpr int file_of( square_t const sq ) { return ( sq & 7 ) + 1; }
+
+    constexpr square_t to_square( pieces::position_t const & pos )
+    {
+        return make_square( static_cast< int >( pos.first ), static_cast< int >( pos.second ) );
+    }
+
+    constexpr pieces::position_t to_position( square_t const sq )
+    {
+        return { static_cast< pieces::rank_t >( rank_of( sq ) ), static_cast< pieces::file_t >( file_of( sq ) ) };
+    }
+
+    constexpr bool is_set( bitboard_t const bb, square_t const sq ) { return bb & square_bb( sq ); }
+
+    constexpr int popcount( bitboard_t const bb ) { return std::popcount( bb ); }
+
+    // index of the least significant set bit, bb must not be empty
+    constexpr square_t lsb( bitboard_t const bb ) { return std::countr_zero( bb ); }
+
+    // removes and returns the least significant set bit, bb must not be empty
+    constexpr square_t pop_lsb( bitboard_t & bb )
+    {
+        square_t sq = lsb( bb );
+        bb &= bb - 1;
+        return sq;
+    }
+
+    constexpr piece_index make_piece_index( pieces::name_t const type, bool const white )
+    {
+        int index = 0;
+        switch ( type ) {
+        case pieces::name_t::pawn:
+            index = white_pawn;
+            break;
+        case pieces::name_t::knight:
+            index = white_knight;
+            break;
+        case pieces::name_t::bishop:
+            index = white_bishop;
+            break;
+        case pieces::name_t::rook:
+            index = white_rook;
+            break;
+        case pieces::name_t::queen:
+            index = white_queen;
+            break;
+        case pieces::name_t::king:
+            index = white_king;
+            break;
+        }
+
+        return static_cast< piece_index >( white ? index : index + 6 );
+    }
+
+    constexpr bool piece_colour( piece_index const index ) { return index < black_pawn; }
+
+    constexpr pieces::name_t piece_type( piece_index const index )
+    {
+        switch ( index % 6 ) {
+        case white_pawn:
+            return pieces::name_t::pawn;
+        case white_knight:
+            return pieces::name_t::knight;
+        case white_bishop:
+            return pieces::name_t::bishop;
+        case white_rook:
+            return pieces::name_t::rook;
+        case white_queen:
+            return pieces::name_t::queen;
+        default:
+            return pieces::name_t::king;
+        }
+    }
+}  // namespace chess::game
+
+#endif
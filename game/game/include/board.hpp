@@ -1,35 +1,52 @@
 #ifndef __CHESS__GAME__BOARD__
 #define __CHESS__GAME__BOARD__
 
-#include <map>
+#include <array>
+#include <bitboard.hpp>
+#include <move.hpp>
+#include <mutex>
+#include <packed.hpp>
 #include <piece.hpp>
+#include <position.hpp>
 #include <space.hpp>
+#include <string_view>
+#include <zobrist.hpp>
 
 namespace chess::game {
 
-    using file_t = std::map< pieces::file_t, space >;   // cols
-    using rank_t = std::map< pieces::rank_t, file_t >;  // rows
-
     class board {
 
     private:
-        // NOTE: do to the nature of the entries of this map the [] operator will cause a compile error
-        // please use the at() function
-        rank_t game_board;
+        // the position itself, bitboards per coloured piece type and per colour plus a mailbox, with the game fields
+        // the chess_game class keeps in it. the board only maintains the pieces, the key of the pieces and the kings
+        position_state position;
+
+        // scores summed into position.table_score as pieces are put down and taken off, none if null
+        piece_square_table const * table = nullptr;
+
+        // only the UI and the move history use these. the spaces are brought up to date with the mailbox one at a
+        // time as they are read, so playing, copying and restoring positions never touches the heap pieces. reading
+        // is const but writes the space, so the sync is done under the mutex for the threads sharing a board
+        struct cold_t {
+            mutable std::array< space, num_squares > squares;
+            std::vector< std::string >               move_history;
+            mutable std::mutex                       squares_mutex;
+        };
 
-        std::vector< std::string > move_history;
+        cold_t cold;
 
         // an init function to place all the pieces on the board
         void place_pieces();
 
-        // these functions implement collision detection into other pieces
-        // does not handle castling and pawn moves, nor does it handle checks
-        void filter_pawn_moves( space const & current, std::vector< space > & moves ) const;
-        void filter_knight_moves( space const & current, std::vector< space > & moves ) const;
-        void filter_bishop_moves( space const & current, std::vector< space > & moves ) const;
-        void filter_rook_moves( space const & current, std::vector< space > & moves ) const;
-        void filter_queen_moves( space const & current, std::vector< space > & moves ) const;
-        void filter_king_moves( space const & current, std::vector< space > & moves ) const;
+        // every change to the pieces goes through these two so the bitboards, mailbox, key and kings stay in sync
+        void        put_piece( square_t const sq, piece_index const index );
+        piece_index take_piece( square_t const sq );
+
+        // makes the space on sq hold the piece the mailbox has there
+        void sync_space( square_t const sq ) const;
+
+        // pushes and captures available to a pawn on sq
+        bitboard_t pawn_targets( square_t const sq, bool const white ) const;
 
         void add_pawn_attacks( space const & current, std::vector< pieces::position_t > & moves ) const;
         void add_knight_attacks( space const & current, std::vector< pieces::position_t > & moves ) const;
@@ -67,28 +84,72 @@ namespace chess::game {
         // contstruct board from frozen string encoding
         board( const std::string & board_string );
 
+        // copies the position and move history, the spaces of the copy are filled in as they are read
+        board( board const & other );
+        board & operator=( board const & other );
+
         void load_from_string( std::string const & board_string );
+        // loads the piece placement field of a FEN record, throws std::invalid_argument if it is malformed
+        void load_from_fen( std::string_view const placement );
+        // writes the piece placement field of a FEN record to out (at most 71 characters), returns the length written
+        std::size_t write_fen( char * out ) const;
+        // loads the occupancy and piece nibbles of a packed position, throws std::invalid_argument if they are malformed
+        void load_from_packed( packed_position const & position );
+        // fills in the occupancy and piece nibbles of position, throws std::invalid_argument if there are more than
+        // max_packed_pieces pieces on the board
+        void write_packed( packed_position & position ) const;
 
         std::vector< space >              possible_moves( space const & src ) const;
         std::vector< pieces::position_t > possible_attacks( space const & src ) const;
 
+        // destinations of the piece on sq ignoring checks and castling, the game class handles those
+        bitboard_t pseudo_targets( square_t const sq ) const;
+        // squares attacked by the piece on sq, own pieces included, empty if there is no piece
+        bitboard_t attacks_from( square_t const sq ) const;
+        // pieces of the given colour that attack sq when only the squares in blockers are occupied
+        bitboard_t attackers_to( square_t const sq, bool const colour, bitboard_t const blockers ) const;
+
         // this function will perform illegal moves (or legal ones) if src contains a piece
         pieces::move_status move_force( pieces::position_t const & src, pieces::position_t const & dst );
+        // plays m without checking it, a king moving two files castles and a pawn reaching the last rank promotes
+        void play( game::move const m );
+        // puts back the position from before the last move played and drops that move from the history
+        void undo( position_state const & before );
         // this function checks for logic then moves if valid
         pieces::move_status move( pieces::position_t const & src, pieces::position_t const & dst );
 
-        std::vector< std::string > get_move_history() const;
+        std::vector< std::string > const & get_move_history() const;
 
         std::string to_string() const;
 
-        // returns a reference to the space at the given position
-        space const & get( pieces::position_t pos ) const;
+        // returns a copy of the space at the given position, made under the lock so other threads can read too
+        space get( pieces::position_t pos ) const;
+        space get( square_t const sq ) const;
+
+        // bitboard accessors
+        bitboard_t  piece_set( piece_index const index ) const { return position.piece_bb[index]; }
+        bitboard_t  piece_set( pieces::name_t const type, bool const white ) const;
+        bitboard_t  colour_set( bool const white ) const { return position.colour_bb[white]; }
+        bitboard_t  occupancy() const { return position.colour_bb[0] | position.colour_bb[1]; }
+        piece_index piece_on( square_t const sq ) const { return position.mailbox[sq]; }
+        square_t    king_square( bool const white ) const { return position.king_square[white]; }
+
+        zobrist_key_t  hash() const { return position.key; }
+        zobrist_key_t  pawn_hash() const { return position.pawn_key; }
+        material_key_t material_key() const { return position.material_key; }
 
-        void        remove_piece_at( pieces::position_t const position );
-        static void remove_piece_at( rank_t & board, pieces::position_t position );
+        // makes the board keep the sum of the table's entries for its pieces up to date, null stops it. positions
+        // taken with state() before the change hold the sum for the old table
+        void                       set_piece_square_table( piece_square_table const * const scores );
+        piece_square_table const * get_piece_square_table() const { return table; }
+        float                      table_score() const { return position.table_score; }
 
-        void        add_piece_at( pieces::piece const & p, pieces::position_t const position );
-        static void add_piece_at( rank_t & board, pieces::piece const & p, pieces::position_t const position );
+        // the position as a trivially copyable value, the game fields in it are for the chess_game class to keep
+        position_state const & state() const { return position; }
+        position_state &       state() { return position; }
+
+        void remove_piece_at( pieces::position_t const position );
+        void add_piece_at( pieces::piece const & p, pieces::position_t const position );
 
         void reset( bool const empty = false );
 
@@ -98,10 +159,6 @@ namespace chess::game {
         // this function returns true even if target is under threat regardless
         bool determine_threat( space const & src, space const & dst, space const & target,
                                bool const victim_colour ) const;
-
-        file_t const & operator[]( pieces::rank_t rank ) const { return game_board.at( rank ); }
-
-        file_t & operator[]( pieces::rank_t rank ) { return game_board.at( rank ); }
     };
 }  // namespace chess::game
 
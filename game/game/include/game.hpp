@@ -1,28 +1,20 @@
 #ifndef __CHESS__GAME__
 #define __CHESS__GAME__
 
-#include "king.hpp"
+#include <array>
+#include <bitboard.hpp>
 #include <board.hpp>
 #include <memory>
+#include <move.hpp>
+#include <packed.hpp>
 #include <piece.hpp>
+#include <position.hpp>
 #include <space.hpp>
+#include <string_view>
+#include <vector>
+#include <zobrist.hpp>
 
 namespace chess {
-    enum class game_state {
-        white_move,
-        black_move,
-        white_check,
-        black_check,
-        white_wins,
-        black_wins,
-        white_offers_draw,
-        black_offers_draw,
-        white_resigns,
-        black_resigns,
-        draw,
-        invalid_game_state,
-    };
-
     inline std::string to_string( game_state state )
     {
         switch ( state ) {
@@ -55,18 +47,72 @@ namespace chess {
         }
     }
 
-    using move_t = std::pair< game::space, game::space >;
+    using move_t = game::move;
+
+    // piece values the exchange evaluation works in, pawn units like the AI's material values. the king is worth
+    // more than everything else together so an exchange never ends with it being taken
+    constexpr int see_value( pieces::name_t const type )
+    {
+        switch ( type ) {
+        case pieces::name_t::pawn:
+            return 1;
+        case pieces::name_t::knight:
+        case pieces::name_t::bishop:
+            return 3;
+        case pieces::name_t::rook:
+            return 5;
+        case pieces::name_t::queen:
+            return 9;
+        default:
+            return 1000;
+        }
+    }
 
     class chess_game {
     private:
-        game_state  state;
+        // the board holds the position_state, pieces and game fields alike, this class keeps the game fields in it
         game::board game_board;
 
-        // based on the moved piece thene functions update the castling status flags
-        void white_castling_rights( std::unique_ptr< pieces::piece > const & moved_piece,
-                                    pieces::position_t const &               src_pos );
-        void black_castling_rights( std::unique_ptr< pieces::piece > const & moved_piece,
-                                    pieces::position_t const &               src_pos );
+        // make_move keeps a copy of the position it started from, unmake_move puts it back
+        struct undo_t {
+            move_t               move;
+            game::position_state before;
+        };
+
+        std::vector< undo_t > undo_stack;
+
+        // keys of the positions make_move started from, the one before the move at undo_stack[i] is at i modulo the
+        // size. only positions since the last capture or pawn move can repeat. nothing ends the game at the fifty
+        // move rule, so is_repetition looks back at most size - 1 plies, past that the slots have been reused
+        static constexpr std::size_t key_history_size = 128;
+
+        std::array< game::zobrist_key_t, key_history_size > key_history;
+
+        game::position_state &       position() { return game_board.state(); }
+        game::position_state const & position() const { return game_board.state(); }
+
+        // square of the least valuable piece of the given colour in attackers, num_squares if there is none
+        game::square_t least_valuable( game::bitboard_t const attackers, bool const colour ) const;
+
+        // shared by the FEN and EPD loaders, everything after the castling rights is optional
+        void load_fen_fields( std::string_view const placement, std::string_view const side,
+                              std::string_view const castling, std::string_view const en_passant_square,
+                              std::string_view const halfmove, std::string_view const fullmove );
+
+        // clears the castling rights whose king or rook is not on its home square
+        void drop_unusable_castling_rights();
+
+        // sets the state from the side to move and whether it is in check once a position is loaded, and starts a fresh
+        // history
+        void finish_load( bool const white );
+
+        game::zobrist_key_t compute_state_key() const;
+
+        // squares whose contents the move in undo changes, the rook's squares included for castling
+        static game::bitboard_t changed_squares( undo_t const & undo );
+
+        // clears the castling rights lost by a king or rook leaving its square or a rook being taken
+        void update_castling_rights( move_t const & move );
 
         // Extract the board portion from the game string
         std::string extract_board_portion( const std::string & game_string );
@@ -82,66 +128,57 @@ namespace chess {
 
         // Parse castle right from line
         bool parse_castle_right( const std::string & line );
+        void set_castling_right( game::castling_right const right, bool const available );
 
         // Convert string to game_state enum
         game_state parse_game_state_enum( const std::string & state_str );
 
-        // Main function prototype
-        pieces::move_status possible_moves( game::board & board_copy, const game::space & src,
-                                            std::vector< game::space > & possible_moves ) const;
-
         // Turn validation
         pieces::move_status validate_turn( const game::space & src ) const;
 
-        // Castling square helpers
-        std::vector< game::space > get_white_kingside_squares( game::board & board_copy ) const;
-        std::vector< game::space > get_white_queenside_squares( game::board & board_copy ) const;
-        std::vector< game::space > get_black_kingside_squares( game::board & board_copy ) const;
-        std::vector< game::space > get_black_queenside_squares( game::board & board_copy ) const;
-
-        // Castling safety validation
-        bool are_castle_squares_safe( game::board & board_copy, const std::vector< game::space > & castle_squares,
-                                      bool piece_colour ) const;
-
-        // Castling move addition
-        void add_white_castling_moves( game::board & board_copy, const game::space & src,
-                                       std::vector< game::space > & possible_moves ) const;
-
-        void add_black_castling_moves( game::board & board_copy, const game::space & src,
-                                       std::vector< game::space > & possible_moves ) const;
-
-        void add_castling_moves( game::board & board_copy, const game::space & src,
-                                 std::vector< game::space > & possible_moves ) const;
+        // what one side needs to know to generate only legal moves, computed once per position
+        struct legality_t {
+            game::square_t   king;      // num_squares if the side has no king
+            game::bitboard_t checkers;  // enemy pieces giving check
+            game::bitboard_t pinned;    // own pieces that may only move along the line to their king
+            game::bitboard_t evasions;  // squares a non-king move has to land on, every square when not in check
+        };
 
-        // Move safety validation
-        bool is_king_move_safe( game::board & board_copy, const game::space & src, const game::space & dst ) const;
+        legality_t legality( bool const colour ) const;
 
-        bool is_non_king_move_safe( game::board & board_copy, const game::space & src, const game::space & dst ) const;
+        // colour whose turn it is, a mated or stalemated side still being the side to move
+        bool side_to_move() const;
 
-        bool is_move_legal( game::board & board_copy, const game::space & src, const game::space & dst ) const;
+        // true if the given colour has at least one legal move, stops at the first one found
+        bool has_legal_move( bool const colour ) const;
+        // true if move, already on the board, checks the other king with the piece that moved, the rook it castled
+        // with or a slider it uncovered
+        bool gives_check( move_t const & move ) const;
 
-        // Move filtering
-        void filter_illegal_moves( game::board & board_copy, const game::space & src,
-                                   std::vector< game::space > & possible_moves ) const;
+        // legal destinations of the piece on sq, castling excluded
+        game::bitboard_t legal_targets( game::square_t const sq, legality_t const & info ) const;
+        // destinations of the castling moves available to the king of the given colour
+        game::bitboard_t castling_targets( bool const colour, legality_t const & info ) const;
+        // appends every legal move of the piece on sq, castling last
+        void add_legal_moves( game::square_t const sq, legality_t const & info, game::move_list & moves ) const;
+        // appends the legal moves of the given kind for one side, a piece type at a time
+        template < game::gen_type type, bool white >
+        void generate( legality_t const & info, game::move_list & moves ) const;
 
     public:
-        struct color_attack_map {
-            int                               num_attackers;
-            std::vector< pieces::position_t > attacker_spaces;
-
-            void        clear();
-            void        add_attacker( pieces::position_t attacker );
-            void        remove_attacker( pieces::position_t attacker );
-            std::string to_string() const;
-        };
-
+        // squares each colour attacks, kept as plain bitboards so copying a game copies no heap memory
         struct attack_map {
-            color_attack_map white_attack_map[8][8];
-            color_attack_map black_attack_map[8][8];
+            game::bitboard_t attackers[2][game::num_squares];  // by colour (1 is white) and attacked square
+            game::bitboard_t attacks_from[game::num_squares];  // squares attacked by the piece counted on each square
+            game::bitboard_t sources[2];                       // squares whose attacks are counted, by colour
+
+            void clear();
+            // recounts the attacks of the pieces on the changed squares and of the sliders whose rays reach them,
+            // changed holds every square whose contents differ from the last update
+            void update( game::board const & b, game::bitboard_t const changed );
+            // counts every piece of b from scratch, cheaper than an update with every square changed
+            void rebuild( game::board const & b );
 
-            void        clear();
-            void        add_attacker( game::space const & attacker, pieces::position_t const & position_attacked );
-            void        remove_attacker( game::space const & attacker, pieces::position_t const & position_attacked );
             bool        has_attackers( game::space const & s, bool color ) const;
             int         num_attackers( game::space const & s, bool color ) const;
             std::string to_string() const;
@@ -149,34 +186,80 @@ namespace chess {
 
         attack_map game_attack_map;
 
-        // set if the king or rook has not moved yet
-        bool king_side_castle_white;
-        bool king_side_castle_black;
-        bool queen_side_castle_white;
-        bool queen_side_castle_black;
-
         chess_game();
         chess_game( std::string const & board_state );
         void load_from_string( std::string const & state );
+        // loads a position from Forsyth-Edwards Notation, throws std::invalid_argument if it is malformed
+        void load_from_fen( std::string_view const fen );
+        // loads the four position fields of an EPD record and returns the operations that follow them
+        std::string_view load_from_epd( std::string_view const epd );
+
+        // longest FEN write_fen can produce
+        static constexpr std::size_t max_fen_length = 128;
+
+        // writes the position as FEN to out, which must hold max_fen_length characters, returns the length written
+        std::size_t write_fen( char * out ) const;
+        std::string to_fen() const;
 
+        // loads a position from its packed binary form, throws std::invalid_argument if it is malformed
+        void load_from_packed( game::packed_position const & packed );
+        // packs the position into 32 bytes, throws std::invalid_argument if it has more than 32 pieces
+        game::packed_position to_packed() const;
+
+        // validates a move from src to dst with is_pseudo_legal and is_legal before playing it
         pieces::move_status move( game::space const & src, game::space const & dst );
 
-        game::space const & get( pieces::position_t const & pos ) const;
+        // the move from src to dst with the flag the generator would give it, castling for a king moving two files and
+        // a queen promotion for a pawn reaching the last rank. the move is not checked
+        move_t to_move( game::square_t const src, game::square_t const dst ) const;
+        // true if the side to move could play move here if its own king's safety is ignored, for moves that do not
+        // come from the generator such as user input or a hashed best move. castling is checked in full
+        bool is_pseudo_legal( move_t const & move ) const;
+        // true if a pseudo legal move does not leave the mover's king attacked
+        bool is_legal( move_t const & move ) const;
+
+        // plays a move taken from legal_moves() without validating it, and records how to take it back
+        pieces::move_status make_move( move_t const & move );
+        // takes back the last move played by make_move
+        void unmake_move();
+
+        game::space get( pieces::position_t const & pos ) const;
 
         std::string to_string() const;
 
         std::vector< game::space > psuedo_possible_moves( game::board game_board, game::space const & src ) const;
         pieces::move_status        possible_moves( game::space const &          src,
                                                    std::vector< game::space > & possible_moves ) const;
-        std::vector< move_t >      legal_moves() const;
-
-        std::vector< game::space > find_attackers( game::space const & src, bool const victim_color ) const;
+        pieces::move_status        possible_moves( game::space const & src, game::move_list & moves ) const;
+        game::move_list            legal_moves() const;
+
+        // appends the legal moves of the given kind for the side to move to moves and returns how many were added,
+        // defined in movegen.cpp for every gen_type
+        template < game::gen_type type >
+        std::size_t generate( game::move_list & moves ) const;
+        // the same for the given colour whoever is to move, so a side can be looked at without changing the turn
+        template < game::gen_type type >
+        std::size_t generate( bool const colour, game::move_list & moves ) const;
+
+        // pieces of the given colour that attack sq, from the attack tables and the current occupancy
+        game::bitboard_t attackers_to( game::square_t const sq, bool const colour ) const;
+        // the same with only the squares in blockers occupied, take pieces out of blockers to see through them
+        game::bitboard_t attackers_to( game::square_t const sq, bool const colour,
+                                       game::bitboard_t const blockers ) const;
+        // attackers of the given colour including the sliders lined up behind them, like a rook behind a queen
+        game::bitboard_t xray_attackers_to( game::square_t const sq, bool const colour ) const;
+
+        // static exchange evaluation: the material the side making move wins, in see_value units, if both sides keep
+        // recapturing on its destination with their least valuable attacker for as long as it pays. pins are ignored
+        int see( move_t const & move ) const;
+        // true if see( move ) >= threshold, stops as soon as the outcome is known
+        bool see_ge( move_t const & move, int const threshold ) const;
 
         bool                              can_castle( bool const color ) const;
 
         void                              add_piece_at(pieces::piece const &p, pieces::position_t const position);
         void                              remove_piece_at( pieces::position_t position );
-        std::vector< std::string >        get_move_history() const;
+        std::vector< std::string > const & get_move_history() const;
         attack_map const                  generate_attack_map( game::board ) const;
         void                              update_attack_map();
         std::vector< pieces::position_t > possible_attacks( game::space const & src ) const;
@@ -188,19 +271,53 @@ namespace chess {
         void start();
         void stop();
 
-        inline game_state const  get_state() const { return state; }
+        inline game_state const  get_state() const { return position().state; }
+        inline int               get_halfmove_clock() const { return position().halfmove_clock; }
+        inline int               get_fullmove_number() const { return position().fullmove_number; }
         inline game::board const get_board() const { return game_board; }
-
-        inline void const set_turn( bool const colour )
+        inline game::bitboard_t  piece_set( pieces::name_t const type, bool const white ) const
         {
-            state = colour ? game_state::white_move : game_state::black_move;
+            return game_board.piece_set( type, white );
         }
+        inline game::bitboard_t  colour_set( bool const white ) const { return game_board.colour_set( white ); }
+        inline game::bitboard_t  occupancy() const { return game_board.occupancy(); }
+        inline game::piece_index piece_on( game::square_t const sq ) const { return game_board.piece_on( sq ); }
+
+        // square of the king of the given colour, num_squares if it has none
+        inline game::square_t king_square( bool const colour ) const { return game_board.king_square( colour ); }
+
+        // zobrist key of the position, maintained incrementally
+        inline game::zobrist_key_t hash() const { return game_board.hash(); }
+        // zobrist key of the pawns of both colours, for caching what only the pawn structure decides
+        inline game::zobrist_key_t pawn_hash() const { return game_board.pawn_hash(); }
+        // how many pieces of each kind are on the board, see game::material_key_t
+        inline game::material_key_t material_key() const { return game_board.material_key(); }
+
+        // the sum of table's entries for the pieces on the board, kept up to date as moves are made and taken back
+        inline void set_piece_square_table( game::piece_square_table const * const table )
+        {
+            game_board.set_piece_square_table( table );
+        }
+        inline game::piece_square_table const * get_piece_square_table() const
+        {
+            return game_board.get_piece_square_table();
+        }
+        inline float table_score() const { return game_board.table_score(); }
+
+        // the searchable position as a trivially copyable value, restore puts one back and rebuilds the attack map.
+        // the move history and undo stack are left as they are
+        inline game::position_state const & snapshot() const { return position(); }
+        void                                 restore( game::position_state const & snapshot );
+
+        void set_turn( bool const colour );
 
         bool checkmate( bool const colour ) const;
 
-        // read only references to the king so we can check for checks
-        std::reference_wrapper< pieces::king const > white_king;
-        std::reference_wrapper< pieces::king const > black_king;
+        // true if the position came up before since the last capture or pawn move, with the same side to move. only
+        // moves played with make_move since the last load count
+        bool is_repetition() const;
+        // true once fifty moves by each side have gone by without a capture or pawn move
+        inline bool fifty_move_rule() const { return position().halfmove_clock >= 100; }
     };
 }  // namespace chess
 
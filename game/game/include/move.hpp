@@ -0,0 +1,116 @@
+#ifndef __CHESS__GAME__MOVE__
+#define __CHESS__GAME__MOVE__
+
+#include <array>
+#include <bitboard.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <piece.hpp>
+#include <string>
+
+namespace chess::game {
+
+    enum class move_flag : std::uint8_t {
+        normal,
+        promotion,
+        castling,
+    };
+
+    // the kinds of legal moves generate produces. captures and quiets split the legal moves in two, promotions
+    // counting as captures and castling as quiet. evasions are the legal moves of a side in check, and none when it
+    // is not in check
+    enum class gen_type : std::uint8_t {
+        captures,
+        quiets,
+        evasions,
+        legal,
+    };
+
+    // a move packed into 16 bits: source square (bits 0-5), destination square (bits 6-11), flag (bits 12-13) and
+    // the promotion piece (bits 14-15, knight, bishop, rook, queen)
+    class move {
+    private:
+        std::uint16_t data;
+
+        static constexpr std::uint16_t square_mask = 0x3F;
+
+        static constexpr pieces::name_t promotion_pieces[4] = { pieces::name_t::knight, pieces::name_t::bishop,
+                                                                pieces::name_t::rook, pieces::name_t::queen };
+
+        static constexpr std::uint16_t promotion_bits( pieces::name_t const piece )
+        {
+            switch ( piece ) {
+            case pieces::name_t::knight:
+                return 0;
+            case pieces::name_t::bishop:
+                return 1;
+            case pieces::name_t::rook:
+                return 2;
+            default:
+                return 3;
+            }
+        }
+
+    public:
+        move() = default;
+
+        constexpr move( square_t const from, square_t const to, move_flag const flag = move_flag::normal,
+                        pieces::name_t const promotion = pieces::name_t::queen ) :
+            data( static_cast< std::uint16_t >( from | ( to << 6 ) | ( static_cast< int >( flag ) << 12 ) |
+                                                ( promotion_bits( promotion ) << 14 ) ) )
+        {
+        }
+
+        constexpr square_t       from() const { return data & square_mask; }
+        constexpr square_t       to() const { return ( data >> 6 ) & square_mask; }
+        constexpr move_flag      flag() const { return static_cast< move_flag >( ( data >> 12 ) & 3 ); }
+        constexpr pieces::name_t promotion() const { return promotion_pieces[data >> 14]; }
+
+        constexpr std::uint16_t raw() const { return data; }
+
+        friend constexpr bool operator==( move const & lhs, move const & rhs ) { return lhs.data == rhs.data; }
+    };
+
+    // long algebraic notation as used by UCI, e.g. e2e4 or e7e8q
+    inline std::string to_string( move const m )
+    {
+        std::string uci = { static_cast< char >( 'a' + file_of( m.from() ) - 1 ),
+                            static_cast< char >( '0' + rank_of( m.from() ) ),
+                            static_cast< char >( 'a' + file_of( m.to() ) - 1 ),
+                            static_cast< char >( '0' + rank_of( m.to() ) ) };
+
+        if ( m.flag() == move_flag::promotion ) {
+            constexpr char symbols[] = { 'r', 'n', 'b', 'k', 'q', 'p' };  // indexed by pieces::name_t
+            uci += symbols[static_cast< int >( m.promotion() )];
+        }
+
+        return uci;
+    }
+
+    // fixed capacity list of moves that lives on the stack, no position has more than 218 legal moves
+    class move_list {
+    public:
+        static constexpr std::size_t capacity = 256;
+
+    private:
+        std::array< move, capacity > moves;
+        std::size_t                  count = 0;
+
+    public:
+        void push_back( move const m ) { moves[count++] = m; }
+        void clear() { count = 0; }
+
+        std::size_t size() const { return count; }
+        bool        empty() const { return count == 0; }
+
+        move &       operator[]( std::size_t const i ) { return moves[i]; }
+        move const & operator[]( std::size_t const i ) const { return moves[i]; }
+
+        move *       begin() { return moves.data(); }
+        move *       end() { return moves.data() + count; }
+        move const * begin() const { return moves.data(); }
+        move const * end() const { return moves.data() + count; }
+    };
+}  // namespace chess::game
+
+#endif
@@ -0,0 +1,66 @@
+#ifndef __CHESS__GAME__PACKED__
+#define __CHESS__GAME__PACKED__
+
+#include <bitboard.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <vector>
+
+namespace chess::game {
+
+    // a position packed into 32 bytes for corpus files, every field is a byte array so the layout is the same on any
+    // machine and a record can be written to disk as it is
+    struct packed_position {
+        std::uint8_t occupancy[8];        // bitboard of the occupied squares, little endian
+        std::uint8_t pieces[16];          // piece_index of each occupied square from A1 up, low nibble first
+        std::uint8_t flags;               // bit 0 is set if white is to move, bits 1-4 are the castling rights KQkq,
+                                          // bits 5-7 are reserved and have to be clear
+        std::uint8_t en_passant;          // square a pawn skipped over, num_squares if there is none
+        std::uint8_t halfmove_clock[2];   // little endian
+        std::uint8_t fullmove_number[2];  // little endian
+        std::uint8_t reserved[2];
+    };
+
+    static_assert( sizeof( packed_position ) == 32 );
+
+    // the piece nibbles have room for this many pieces
+    constexpr int max_packed_pieces = 32;
+
+    // reads packed positions one at a time from a stream of records, in blocks of buffer_size records
+    class packed_reader {
+    private:
+        std::istream &                 in;
+        std::vector< packed_position > buffer;
+        std::size_t                    next;
+        std::size_t                    count;
+
+    public:
+        packed_reader( std::istream & in, std::size_t const buffer_size = 4096 );
+
+        // copies the next record into position, returns false at the end of the stream. throws std::runtime_error if
+        // the stream ends part way through a record
+        bool read( packed_position & position );
+    };
+
+    // writes packed positions to a stream, records are buffered and written in blocks of buffer_size
+    class packed_writer {
+    private:
+        std::ostream &                 out;
+        std::vector< packed_position > buffer;
+
+    public:
+        packed_writer( std::ostream & out, std::size_t const buffer_size = 4096 );
+        ~packed_writer();
+
+        packed_writer( packed_writer const & )             = delete;
+        packed_writer & operator=( packed_writer const & ) = delete;
+
+        void write( packed_position const & position );
+        // writes out the buffered records
+        void flush();
+    };
+}  // namespace chess::game
+
+#endif
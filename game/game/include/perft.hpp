@@ -0,0 +1,25 @@
+#ifndef __CHESS__GAME__PERFT__
+#define __CHESS__GAME__PERFT__
+
+#include <cstddef>
+#include <cstdint>
+#include <game.hpp>
+#include <utility>
+#include <vector>
+
+namespace chess {
+
+    struct perft_options {
+        unsigned    threads     = 1;  // the root moves are shared out between this many threads
+        std::size_t cache_bytes = 0;  // size of the transposition cache shared by all threads, 0 turns it off
+    };
+
+    // number of leaf nodes exactly depth plies below the position
+    std::uint64_t perft( chess_game & game, int const depth );
+
+    // leaf node count below each root move, in generation order
+    std::vector< std::pair< move_t, std::uint64_t > > perft_divide( chess_game const & game, int const depth,
+                                                                    perft_options const & options = {} );
+}  // namespace chess
+
+#endif
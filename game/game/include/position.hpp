@@ -0,0 +1,76 @@
+#ifndef __CHESS__GAME__POSITION__
+#define __CHESS__GAME__POSITION__
+
+#include <bitboard.hpp>
+#include <cstdint>
+#include <type_traits>
+#include <zobrist.hpp>
+
+namespace chess {
+    enum class game_state : std::uint8_t {
+        white_move,
+        black_move,
+        white_check,
+        black_check,
+        white_wins,
+        black_wins,
+        white_offers_draw,
+        black_offers_draw,
+        white_resigns,
+        black_resigns,
+        draw,
+        invalid_game_state,
+    };
+}  // namespace chess
+
+namespace chess::game {
+
+    // one bit per castling right, the bit index is the index into zobrist.castling_availability
+    enum castling_right : std::uint8_t {
+        white_king_side  = 1,
+        white_queen_side = 2,
+        black_king_side  = 4,
+        black_queen_side = 8,
+    };
+
+    // the number of pieces of every piece_index, four bits each with white_pawn in the lowest. it is the material on
+    // the board exactly, so it can key a table without collisions
+    using material_key_t = std::uint64_t;
+
+    // the amount one piece of the given index adds to a material key
+    constexpr material_key_t material_unit( piece_index const index ) { return material_key_t{ 1 } << ( 4 * index ); }
+
+    constexpr int material_count( material_key_t const key, piece_index const index )
+    {
+        return static_cast< int >( ( key >> ( 4 * index ) ) & 15 );
+    }
+
+    // a score for every piece on every square, by piece_index and square. entries count towards white, so black's
+    // are usually negated
+    struct piece_square_table {
+        float score[num_piece_indices][num_squares];
+    };
+
+    // everything the search reads and writes about a position and nothing else, so taking or restoring a snapshot
+    // is a plain copy. the space view, move history and undo stack are kept elsewhere
+    struct position_state {
+        bitboard_t     piece_bb[num_piece_indices];
+        bitboard_t     colour_bb[2];          // indexed by colour, 1 is white
+        piece_index    mailbox[num_squares];  // piece on every square, no_piece if empty
+        zobrist_key_t  key;                   // zobrist key of the pieces, side to move and castling rights
+        zobrist_key_t  pawn_key;              // zobrist key of the pawns alone
+        material_key_t material_key;          // piece counts, see material_key_t
+        std::uint8_t   king_square[2];        // by colour, num_squares if that side has no king
+        std::uint8_t   castling;              // castling_right bits still available
+        std::uint8_t   en_passant;            // square a pawn skipped over with the last move, num_squares if none
+        game_state     state;
+        std::uint16_t  halfmove_clock;   // plies since the last capture or pawn move
+        std::uint16_t  fullmove_number;  // starts at 1 and goes up after black moves
+        float          table_score;      // sum of the board's piece_square_table entries for the pieces, 0 without one
+    };
+
+    static_assert( std::is_trivially_copyable_v< position_state > );
+    static_assert( sizeof( position_state ) <= 216 );
+}  // namespace chess::game
+
+#endif
@@ -0,0 +1,50 @@
+#ifndef __CHESS__GAME__ZOBRIST__
+#define __CHESS__GAME__ZOBRIST__
+
+#include <bitboard.hpp>
+#include <cstdint>
+
+namespace chess::game {
+
+    using zobrist_key_t = std::uint64_t;
+
+    struct zobrist_t {
+        zobrist_key_t piece_square[num_piece_indices][num_squares];  // indexed by piece_index and square
+        zobrist_key_t castling_availability[4];  // white king-side, white queen-side, black king-side, black queen-side
+        zobrist_key_t white_to_move;
+    };
+
+    // splitmix64, small enough to run at compile time
+    constexpr zobrist_key_t next_zobrist_key( zobrist_key_t & seed )
+    {
+        zobrist_key_t z = ( seed += 0x9E3779B97F4A7C15ULL );
+        z               = ( z ^ ( z >> 30 ) ) * 0xBF58476D1CE4E5B9ULL;
+        z               = ( z ^ ( z >> 27 ) ) * 0x94D049BB133111EBULL;
+        return z ^ ( z >> 31 );
+    }
+
+    constexpr zobrist_t make_zobrist_tables()
+    {
+        zobrist_t     tables{};
+        zobrist_key_t seed = 20250517;
+
+        for ( int i = 0; i < num_piece_indices; i++ ) {
+            for ( int j = 0; j < num_squares; j++ ) {
+                tables.piece_square[i][j] = next_zobrist_key( seed );
+            }
+        }
+
+        for ( int i = 0; i < 4; i++ ) {
+            tables.castling_availability[i] = next_zobrist_key( seed );
+        }
+
+        tables.white_to_move = next_zobrist_key( seed );
+
+        return tables;
+    }
+
+    // shared by every position, generated at compile time
+    inline constexpr zobrist_t zobrist = make_zobrist_tables();
+}  // namespace chess::game
+
+#endif
@@ -0,0 +1,114 @@
+#include <attacks.hpp>
+#include <bitboard.hpp>
+
+namespace chess::game {
+
+    namespace {
+        // found offline by random search, each one maps every blocker subset of the square's mask to an index
+        // without destructive collisions
+        constexpr bitboard_t bishop_magics[num_squares] = {
+            0x0020200204410128ULL, 0x0304102429162010ULL, 0x2410041080200010ULL, 0x0284040088902800ULL,
+            0x000410A803001229ULL, 0x8802011008202200ULL, 0x2C00444208400880ULL, 0x0002808050100420ULL,
+            0x1682500508088C00ULL, 0x8042084208020420ULL, 0x8085410401004240ULL, 0x4000442502000800ULL,
+            0x0000411040220005ULL, 0x0801111022100050ULL, 0x041B10A890082080ULL, 0x0004002208048440ULL,
+            0x40A0024048820088ULL, 0x0884401071060400ULL, 0xB4288010082A0020ULL, 0x28140109C0408100ULL,
+            0x001402A080A04010ULL, 0x2006000908020282ULL, 0x8229040841182081ULL, 0x0022021704908460ULL,
+            0x3824410010026814ULL, 0x4008020004040820ULL, 0x0202010902040402ULL, 0x0831040088020860ULL,
+            0x0904082004002002ULL, 0x0450004402080200ULL, 0x2108104500820800ULL, 0x060301000026A800ULL,
+            0x005190C002300C00ULL, 0x0041502800904100ULL, 0x2000804109900400ULL, 0x0024040400180210ULL,
+            0x0812120400260082ULL, 0x1010100080804040ULL, 0x02020801120A0084ULL, 0x0004004480004404ULL,
+            0x0404210440001004ULL, 0x0284120805040200ULL, 0x0001002901011011ULL, 0x0400204200802800ULL,
+            0x0010200431420401ULL, 0x100802080A100808ULL, 0x0008480828400881ULL, 0x0024840052001044ULL,
+            0x004084141A420040ULL, 0x00028084C8201020ULL, 0x2002802402080901ULL, 0x2002080A10440000ULL,
+            0x02A4071042088400ULL, 0x20000A8810042048ULL, 0x10C0111204910428ULL, 0x0004042092120400ULL,
+            0x3001010050420800ULL, 0x0200060100821004ULL, 0x0148000094008801ULL, 0x8800020920840400ULL,
+            0x4080210024050C01ULL, 0x010010080208A202ULL, 0x004011A008008080ULL, 0x20020204280601C0ULL,
+        };
+
+        constexpr bitboard_t rook_magics[num_squares] = {
+            0x2880001020400081ULL, 0x0140012001401002ULL, 0x2180089000A00080ULL, 0x9080080004801001ULL,
+            0x0200020008200410ULL, 0x9100060C00289100ULL, 0x2880800100008200ULL, 0x0200008222010C44ULL,
+            0x82058000804000A0ULL, 0x0240804000200081ULL, 0x1004805000816001ULL, 0x1412001022014008ULL,
+            0x8402800400080180ULL, 0x0AC0800401800200ULL, 0x8001010004010200ULL, 0x0005000300058042ULL,
+            0x01C041002080010AULL, 0x0050044000200040ULL, 0x8000110040200100ULL, 0x0010008008011380ULL,
+            0x0008010010040900ULL, 0x4020808004000200ULL, 0x2682040001108208ULL, 0x02400A0004844104ULL,
+            0x0408401680002180ULL, 0x2008200880400080ULL, 0x040300B300406000ULL, 0x0210100080800800ULL,
+            0x0100040080080080ULL, 0x0001008300040028ULL, 0x001A081400100A41ULL, 0x0001050200019844ULL,
+            0xA400400082800220ULL, 0x0A10400090802000ULL, 0x4000100080802001ULL, 0x4090004402400800ULL,
+            0x0A04800800800402ULL, 0x0002020080800400ULL, 0x4002411004001822ULL, 0x20D1000045001A92ULL,
+            0x0000604000818002ULL, 0x4210005020084000ULL, 0x8040804012020020ULL, 0x0C00080010008080ULL,
+            0x8800040008008080ULL, 0x0000020004008080ULL, 0x0000021081040008ULL, 0x0101004418860015ULL,
+            0x0000810028420200ULL, 0x2120003080400880ULL, 0x0001004010200100ULL, 0x0A10008010080080ULL,
+            0x0808009804008180ULL, 0x0102000280040080ULL, 0x0408501218414400ULL, 0x0812204404890200ULL,
+            0x0810110180032045ULL, 0x4021400214810021ULL, 0x840622800A004012ULL, 0x0015002008041003ULL,
+            0x3002001008208482ULL, 0x0203000208040001ULL, 0x0400210800900264ULL, 0x8002008040240102ULL,
+        };
+
+        // walks from sq in the direction (rank_step, file_step) until the edge of the board or the first occupied
+        // square, the blocker is included
+        bitboard_t ray( square_t const sq, int const rank_step, int const file_step, bitboard_t const occupied )
+        {
+            bitboard_t targets = empty_bb;
+
+            int rank = rank_of( sq ) + rank_step;
+            int file = file_of( sq ) + file_step;
+            for ( ; rank >= 1 && rank <= 8 && file >= 1 && file <= 8; rank += rank_step, file += file_step ) {
+                square_t target = make_square( rank, file );
+                targets |= square_bb( target );
+
+                if ( is_set( occupied, target ) ) {
+                    break;
+                }
+            }
+
+            return targets;
+        }
+
+        bitboard_t slow_bishop_attacks( square_t const sq, bitboard_t const occupied )
+        {
+            return ray( sq, 1, 1, occupied ) | ray( sq, 1, -1, occupied ) | ray( sq, -1, 1, occupied ) |
+                   ray( sq, -1, -1, occupied );
+        }
+
+        bitboard_t slow_rook_attacks( square_t const sq, bitboard_t const occupied )
+        {
+            return ray( sq, 1, 0, occupied ) | ray( sq, -1, 0, occupied ) | ray( sq, 0, 1, occupied ) |
+                   ray( sq, 0, -1, occupied );
+        }
+
+        // fills in one slider's entries, returns the first free slot of the table after them
+        bitboard_t * init_magics( magic_t ( &magics )[num_squares], bitboard_t const ( &magic_numbers )[num_squares],
+                                  bitboard_t ( *slow_attacks )( square_t const, bitboard_t const ),
+                                  bitboard_t * table )
+        {
+            for ( square_t sq = 0; sq < num_squares; sq++ ) {
+                // a blocker on the last square of a ray never changes the attacks
+                bitboard_t edges = ( ( rank_1_bb | rank_8_bb ) & ~( rank_1_bb << ( 8 * ( rank_of( sq ) - 1 ) ) ) ) |
+                                   ( ( file_a_bb | file_h_bb ) & ~( file_a_bb << ( file_of( sq ) - 1 ) ) );
+
+                auto & entry   = magics[sq];
+                entry.mask     = slow_attacks( sq, empty_bb ) & ~edges;
+                entry.magic    = magic_numbers[sq];
+                entry.shift    = 64 - popcount( entry.mask );
+                entry.attacks  = table;
+
+                // enumerate every subset of the mask (carry-rippler)
+                bitboard_t subset = empty_bb;
+                do {
+                    entry.attacks[entry.index( subset )] = slow_attacks( sq, subset );
+                    subset                               = ( subset - entry.mask ) & entry.mask;
+                } while ( subset );
+
+                table += 1ULL << popcount( entry.mask );
+            }
+
+            return table;
+        }
+    }  // namespace
+
+    slider_tables_t::slider_tables_t()
+    {
+        auto next = init_magics( bishop, bishop_magics, slow_bishop_attacks, table.data() );
+        init_magics( rook, rook_magics, slow_rook_attacks, next );
+    }
+}  // namespace chess::game
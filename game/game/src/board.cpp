@@ -1,5 +1,6 @@
 #include "game.hpp"
 #include "space.hpp"
+#include <attacks.hpp>
 #include <bishop.hpp>
 #include <board.hpp>
 #include <cstdlib>
@@ -14,34 +15,284 @@
 #include <algorithm>
 #include <iostream>
 #include <memory>
+#include <mutex>
 #include <sstream>
+#include <utility>
 #include <vector>
 
 namespace chess::game {
 
-    board::board( bool const empty ) { reset( empty ); }
+    namespace {
+        template < std::size_t... sq >
+        std::array< space, num_squares > make_empty_squares( std::index_sequence< sq... > )
+        {
+            return { space( ( rank_of( sq ) + file_of( sq ) ) % 2 == 1, to_position( sq ).first,
+                            to_position( sq ).second )... };
+        }
 
-    void board::reset( bool const empty )
+        std::array< space, num_squares > empty_squares()
+        {
+            return make_empty_squares( std::make_index_sequence< num_squares >() );
+        }
+    }  // namespace
+
+    board::board( bool const empty ) : cold{ empty_squares(), {}, {} } { reset( empty ); }
+
+    board::board( board const & other )
+        : position( other.position ), table( other.table ), cold{ empty_squares(), other.cold.move_history, {} }
     {
-        game_board = {};
-        for ( int i = 1; i <= 8; i++ ) {
-            file_t file_map;
-            auto   rank = static_cast< pieces::rank_t >( i );
-            for ( int j = 1; j <= 8; j++ ) {
-                auto file = static_cast< pieces::file_t >( j );
+    }
 
-                file_map.emplace( file, space( ( i + j ) % 2 == 1, rank, file ) );
+    board & board::operator=( board const & other )
+    {
+        position          = other.position;
+        table             = other.table;
+        cold.move_history = other.cold.move_history;
+
+        std::lock_guard< std::mutex > lock( cold.squares_mutex );
+        for ( auto & sp : cold.squares ) {
+            sp.piece.reset();
+        }
+        return *this;
+    }
+
+    void board::set_piece_square_table( piece_square_table const * const scores )
+    {
+        table                = scores;
+        position.table_score = 0.0f;
+
+        if ( table ) {
+            for ( auto occupied = occupancy(); occupied; ) {
+                auto sq = pop_lsb( occupied );
+                position.table_score += table->score[position.mailbox[sq]][sq];
             }
-            game_board[rank] = std::move( file_map );
         }
+    }
+
+    void board::reset( bool const empty )
+    {
+        position = position_state{
+            .piece_bb        = {},
+            .colour_bb       = {},
+            .mailbox         = {},
+            .key             = 0,
+            .pawn_key        = 0,
+            .material_key    = 0,
+            .king_square     = { num_squares, num_squares },
+            .castling        = 0,
+            .en_passant      = num_squares,
+            .state           = game_state::white_move,
+            .halfmove_clock  = 0,
+            .fullmove_number = 1,
+            .table_score     = 0.0f,
+        };
+        std::fill( std::begin( position.mailbox ), std::end( position.mailbox ), no_piece );
 
         if ( !empty )
             place_pieces();
     }
 
-    board::board( const std::string & board_string ) { load_from_string( board_string ); }
+    board::board( const std::string & board_string ) : cold{ empty_squares(), {}, {} }
+    {
+        load_from_string( board_string );
+    }
+
+    void board::put_piece( square_t const sq, piece_index const index )
+    {
+        take_piece( sq );
+
+        if ( index == no_piece ) {
+            return;
+        }
+
+        bool colour = piece_colour( index );
+
+        position.piece_bb[index] |= square_bb( sq );
+        position.colour_bb[colour] |= square_bb( sq );
+        position.mailbox[sq] = index;
+        position.key ^= zobrist.piece_square[index][sq];
+        position.material_key += material_unit( index );
+        if ( index == white_pawn || index == black_pawn ) {
+            position.pawn_key ^= zobrist.piece_square[index][sq];
+        }
+        if ( table ) {
+            position.table_score += table->score[index][sq];
+        }
+
+        if ( piece_type( index ) == pieces::name_t::king ) {
+            position.king_square[colour] = static_cast< std::uint8_t >( lsb( position.piece_bb[index] ) );
+        }
+    }
+
+    piece_index board::take_piece( square_t const sq )
+    {
+        auto index = position.mailbox[sq];
+        if ( index == no_piece ) {
+            return no_piece;
+        }
+
+        bool colour = piece_colour( index );
+
+        position.piece_bb[index] &= ~square_bb( sq );
+        position.colour_bb[colour] &= ~square_bb( sq );
+        position.mailbox[sq] = no_piece;
+        position.key ^= zobrist.piece_square[index][sq];
+        position.material_key -= material_unit( index );
+        if ( index == white_pawn || index == black_pawn ) {
+            position.pawn_key ^= zobrist.piece_square[index][sq];
+        }
+        if ( table ) {
+            position.table_score -= table->score[index][sq];
+        }
+
+        if ( piece_type( index ) == pieces::name_t::king ) {
+            auto kings                   = position.piece_bb[index];
+            position.king_square[colour] = static_cast< std::uint8_t >( kings ? lsb( kings ) : num_squares );
+        }
 
-    void board::load_from_string( std::string const & state ) { parse_board_string( state ); }
+        return index;
+    }
+
+    void board::sync_space( square_t const sq ) const
+    {
+        auto         index = position.mailbox[sq];
+        auto const & piece = cold.squares[sq].piece;
+
+        if ( index == no_piece ) {
+            cold.squares[sq].piece.reset();
+        }
+        else if ( !piece || make_piece_index( piece->type(), piece->colour() ) != index ||
+                  piece->position() != to_position( sq ) ) {
+            cold.squares[sq].piece = pieces::piece::make_piece( piece_type( index ), piece_colour( index ),
+                                                                to_position( sq ) );
+        }
+    }
+
+    bitboard_t board::piece_set( pieces::name_t const type, bool const white ) const
+    {
+        return position.piece_bb[make_piece_index( type, white )];
+    }
+
+    void board::load_from_string( std::string const & state )
+    {
+        reset( true );
+        parse_board_string( state );
+    }
+
+    void board::load_from_fen( std::string_view const placement )
+    {
+        auto invalid = [placement]() {
+            return std::invalid_argument( "Invalid FEN placement: " + std::string( placement ) );
+        };
+
+        reset( true );
+
+        int rank = 8;
+        int file = 1;
+        for ( char symbol : placement ) {
+            if ( symbol == '/' ) {
+                if ( file != 9 || rank == 1 ) {
+                    throw invalid();
+                }
+                rank--;
+                file = 1;
+            }
+            else if ( symbol >= '1' && symbol <= '8' ) {
+                file += symbol - '0';
+            }
+            else if ( auto index = std::string_view( "PNBRQKpnbrqk" ).find( symbol );
+                      file <= 8 && index != std::string_view::npos ) {
+                put_piece( make_square( rank, file ), static_cast< piece_index >( index ) );
+                file++;
+            }
+            else {
+                throw invalid();
+            }
+
+            if ( file > 9 ) {
+                throw invalid();
+            }
+        }
+
+        if ( rank != 1 || file != 9 ) {
+            throw invalid();
+        }
+    }
+
+    std::size_t board::write_fen( char * out ) const
+    {
+        constexpr char symbols[] = "PNBRQKpnbrqk";  // indexed by piece_index
+
+        char * start = out;
+        for ( int rank = 8; rank >= 1; rank-- ) {
+            int empty = 0;
+            for ( int file = 1; file <= 8; file++ ) {
+                auto index = position.mailbox[make_square( rank, file )];
+                if ( index == no_piece ) {
+                    empty++;
+                    continue;
+                }
+
+                if ( empty ) {
+                    *out++ = static_cast< char >( '0' + empty );
+                    empty  = 0;
+                }
+                *out++ = symbols[index];
+            }
+
+            if ( empty ) {
+                *out++ = static_cast< char >( '0' + empty );
+            }
+            if ( rank > 1 ) {
+                *out++ = '/';
+            }
+        }
+
+        return out - start;
+    }
+
+    void board::load_from_packed( packed_position const & packed )
+    {
+        bitboard_t bb = 0;
+        for ( int i = 0; i < 8; i++ ) {
+            bb |= static_cast< bitboard_t >( packed.occupancy[i] ) << ( 8 * i );
+        }
+
+        if ( popcount( bb ) > max_packed_pieces ) {
+            throw std::invalid_argument( "Invalid packed position: too many pieces" );
+        }
+
+        reset( true );
+
+        for ( int i = 0; bb; i++ ) {
+            auto sq    = pop_lsb( bb );
+            auto index = static_cast< piece_index >( ( packed.pieces[i / 2] >> ( 4 * ( i % 2 ) ) ) & 0xF );
+            if ( index >= no_piece ) {
+                throw std::invalid_argument( "Invalid packed position: bad piece on " +
+                                             pieces::to_string( to_position( sq ) ) );
+            }
+
+            put_piece( sq, index );
+        }
+    }
+
+    void board::write_packed( packed_position & packed ) const
+    {
+        auto occupied = occupancy();
+        if ( popcount( occupied ) > max_packed_pieces ) {
+            throw std::invalid_argument( "Too many pieces to pack the position" );
+        }
+
+        for ( int i = 0; i < 8; i++ ) {
+            packed.occupancy[i] = static_cast< std::uint8_t >( occupied >> ( 8 * i ) );
+        }
+
+        std::fill( std::begin( packed.pieces ), std::end( packed.pieces ), 0 );
+
+        for ( int i = 0; occupied; i++ ) {
+            packed.pieces[i / 2] |= position.mailbox[pop_lsb( occupied )] << ( 4 * ( i % 2 ) );
+        }
+    }
 
     // Parse the entire board string
     void board::parse_board_string( const std::string & board_string )
@@ -111,9 +362,7 @@ namespace chess::game {
         auto file_enum = static_cast< pieces::file_t >( file );
 
         if ( is_empty_space( symbol ) ) {
-            if ( ( *this )[rank_enum].at( file_enum ).piece ) {
-                ( *this )[rank_enum].at( file_enum ).piece.reset();
-            }
+            take_piece( make_square( rank, file ) );
             return;
         }
 
@@ -129,102 +378,98 @@ namespace chess::game {
         bool piece_colour = std::isupper( symbol );  // uppercase = true, lowercase = false
         char piece_type   = std::tolower( symbol );  // normalize to lowercase
 
-        space & current_space = game_board.at( rank ).at( file );
-
+        pieces::name_t type;
         switch ( piece_type ) {
         case 'r':
-            current_space.piece = std::make_unique< pieces::rook >( piece_colour, rank, file );
+            type = pieces::name_t::rook;
             break;
         case 'n':
-            current_space.piece = std::make_unique< pieces::knight >( piece_colour, rank, file );
+            type = pieces::name_t::knight;
             break;
         case 'b':
-            current_space.piece = std::make_unique< pieces::bishop >( piece_colour, rank, file );
+            type = pieces::name_t::bishop;
             break;
         case 'q':
-            current_space.piece = std::make_unique< pieces::queen >( piece_colour, rank, file );
+            type = pieces::name_t::queen;
             break;
         case 'k':
-            current_space.piece = std::make_unique< pieces::king >( piece_colour, rank, file );
+            type = pieces::name_t::king;
             break;
         case 'p':
-            current_space.piece = std::make_unique< pieces::pawn >( piece_colour, rank, file );
+            type = pieces::name_t::pawn;
             break;
         default:
             throw std::invalid_argument( "Invalid piece symbol: " + std::string( 1, symbol ) );
         }
+
+        put_piece( to_square( { rank, file } ), make_piece_index( type, piece_colour ) );
     }
 
     pieces::move_status board::move_force( pieces::position_t const & src, pieces::position_t const & dst )
     {
-        if ( !game_board.at( src.first ).at( src.second ).piece )
+        auto src_sq = to_square( src );
+        auto dst_sq = to_square( dst );
+
+        if ( position.mailbox[src_sq] == no_piece )
             return pieces::move_status::no_piece_to_move;
 
-        auto status = game_board.at( src.first ).at( src.second ).piece->move( dst );
+        // the piece checks the move against how it moves, get hands out a copy so the space view is left alone
+        auto status = get( src_sq ).piece->move( dst );
 
         if ( !is_success_status( status ) ) {
             return status;
         }
 
-        game_board.at( dst.first )
-            .at( dst.second )
-            .piece.reset( game_board.at( src.first ).at( src.second ).piece.release() );
+        play( { src_sq, dst_sq } );
+        return pieces::move_status::valid;
+    }
 
-        // move the rook for castle
-        if ( status == pieces::move_status::king_side_castle_white ) {
-            auto & from = game_board.at( pieces::rank_t::one ).at( pieces::file_t::h ).piece;
-            if ( from ) {
-                from->place( { pieces::rank_t::one, pieces::file_t::f } );
-            }
-            game_board.at( pieces::rank_t::one ).at( pieces::file_t::f ).piece.reset( from.release() );
-            move_history.push_back( "O-O" );
+    void board::play( game::move const m )
+    {
+        auto src   = m.from();
+        auto dst   = m.to();
+        auto moved = take_piece( src );
 
-            return pieces::move_status::valid;
-        }
-        else if ( status == pieces::move_status::king_side_castle_black ) {
-            auto & from = game_board.at( pieces::rank_t::eight ).at( pieces::file_t::h ).piece;
-            if ( from ) {
-                from->place( { pieces::rank_t::eight, pieces::file_t::f } );
-            }
-            game_board.at( pieces::rank_t::eight ).at( pieces::file_t::f ).piece.reset( from.release() );
-            move_history.push_back( "O-O" );
+        bool white = piece_colour( moved );
+        auto type  = piece_type( moved );
 
-            return pieces::move_status::valid;
-        }
-        else if ( status == pieces::move_status::queen_side_castle_white ) {
-            auto & from = game_board.at( pieces::rank_t::one ).at( pieces::file_t::a ).piece;
-            if ( from ) {
-                from->place( { pieces::rank_t::one, pieces::file_t::d } );
-            }
-            game_board.at( pieces::rank_t::one ).at( pieces::file_t::d ).piece.reset( from.release() );
-            move_history.push_back( "O-O-O" );
+        // pawn promotion
+        if ( type == pieces::name_t::pawn && ( rank_of( dst ) == 1 || rank_of( dst ) == 8 ) ) {
+            auto promotion = m.flag() == move_flag::promotion ? m.promotion() : pieces::name_t::queen;
+            put_piece( dst, make_piece_index( promotion, white ) );
 
-            return pieces::move_status::valid;
+            constexpr char symbols[] = "PNBRQK";  // indexed by the piece_index of the white piece
+            cold.move_history.push_back( pieces::to_string( to_position( dst ) ) + "=" +
+                                         symbols[make_piece_index( promotion, true )] );
+            return;
         }
-        else if ( status == pieces::move_status::queen_side_castle_black ) {
-            auto & from = game_board.at( pieces::rank_t::eight ).at( pieces::file_t::a ).piece;
-            if ( from ) {
-                from->place( { pieces::rank_t::eight, pieces::file_t::d } );
-            }
-            game_board.at( pieces::rank_t::eight ).at( pieces::file_t::d ).piece.reset( from.release() );
-            move_history.push_back( "O-O-O" );
 
-            return pieces::move_status::valid;
-        }
+        put_piece( dst, moved );
 
-        // pawn promotion
-        auto & dst_piece = get( dst ).piece;
-        if ( dst_piece && dst_piece->type() == pieces::name_t::pawn ) {
-            if ( dst.first == pieces::rank_t::eight || dst.first == pieces::rank_t::one ) {
-                ( *this )[dst.first].at( dst.second ).piece = std::make_unique< pieces::queen >(
-                    dst_piece->colour(), dst_piece->position().first, dst_piece->position().second );
-
-                move_history.push_back( pieces::to_string( dst ) + "=Q" );
-                return pieces::move_status::valid;
+        // move the rook for castle
+        if ( type == pieces::name_t::king && ( dst - src == 2 || src - dst == 2 ) ) {
+            int rank = rank_of( src );
+            if ( dst > src ) {
+                put_piece( make_square( rank, 6 ), take_piece( make_square( rank, 8 ) ) );
+                cold.move_history.push_back( "O-O" );
+            }
+            else {
+                put_piece( make_square( rank, 4 ), take_piece( make_square( rank, 1 ) ) );
+                cold.move_history.push_back( "O-O-O" );
             }
+            return;
+        }
+
+        cold.move_history.push_back( pieces::to_string( to_position( src ) ) + pieces::to_string( to_position( dst ) ) );
+    }
+
+    void board::undo( position_state const & before )
+    {
+        position = before;
+
+        if ( !cold.move_history.empty() ) {
+            cold.move_history.pop_back();
         }
-        move_history.push_back( pieces::to_string( src ) + pieces::to_string( dst ) );
-        return pieces::move_status::valid;
     }
 
     pieces::move_status board::move( pieces::position_t const & src, pieces::position_t const & dst )
@@ -234,533 +479,161 @@ namespace chess::game {
 
     std::vector< space > board::possible_moves( space const & src ) const
     {
-        auto positions = src.possible_moves();  //
-
-        if ( positions.empty() ) {
+        if ( !src.piece ) {
             return {};
         }
 
         std::vector< space > spaces;
 
-        for ( auto const & pos : positions ) {
-            spaces.push_back( game_board.at( pos.first ).at( pos.second ) );
-        }
-
-        switch ( src.piece->type() ) {
-        case pieces::name_t::rook:
-            filter_rook_moves( src, spaces );
-            break;
-        case pieces::name_t::knight:
-            filter_knight_moves( src, spaces );
-            break;
-        case pieces::name_t::bishop:
-            filter_bishop_moves( src, spaces );
-            break;
-        case pieces::name_t::king:
-            filter_king_moves( src, spaces );
-            break;
-        case pieces::name_t::queen:
-            filter_queen_moves( src, spaces );
-            break;
-        case pieces::name_t::pawn:
-            filter_pawn_moves( src, spaces );
-            break;
+        auto targets = pseudo_targets( to_square( src.position() ) );
+        while ( targets ) {
+            spaces.push_back( get( pop_lsb( targets ) ) );
         }
 
         return spaces;
     }
 
-    void board::remove_piece_at( pieces::position_t const position )
-    {
-        remove_piece_at( ( *this ).game_board, position );
-    }
-    void board::remove_piece_at( rank_t & board, pieces::position_t const position )
-    {
-        board.at( position.first ).at( position.second ).piece.reset();
-    }
-
-    void board::add_piece_at( pieces::piece const & p, pieces::position_t const position )
-    {
-        add_piece_at( ( *this ).game_board, p, position );
-    }
-    void board::add_piece_at( rank_t & board, pieces::piece const & p, pieces::position_t const position )
-    {
-        board.at( position.first ).at( position.second ).piece = pieces::piece::copy_piece( p );
-    }
-
-    std::vector< std::string > board::get_move_history() const { return move_history; }
-
-    void board::filter_pawn_moves( space const & current, std::vector< space > & moves ) const
+    bitboard_t board::pseudo_targets( square_t const sq ) const
     {
-        if ( !current.piece ) {
-            return;
+        auto index = position.mailbox[sq];
+        if ( index == no_piece ) {
+            return empty_bb;
         }
 
-        auto piece_colour = current.piece->colour();
+        auto occupied = occupancy();
 
-        auto x = std::erase_if( moves, [&current, &piece_colour, this]( space const & move ) {
-            if ( std::abs( static_cast< int >( current.position().second ) -
-                           static_cast< int >( move.position().second ) ) == 1 ) {
-                return !move.piece || move.piece->colour() == current.piece->colour();
-            }
-            else {
-                if ( std::abs( static_cast< int >( current.position().first ) -
-                               static_cast< int >( move.position().first ) ) >= 1 ) {
-                    if ( move.piece ) {
-                        return true;
-                    }
-                    else if ( std::abs( static_cast< int >( current.position().first ) -
-                                        static_cast< int >( move.position().first ) ) == 2 ) {
-                        auto rank_val = static_cast< int >( move.position().first );
-                        auto file_val = static_cast< int >( move.position().second );
-                        if ( piece_colour ) {  // if the piece is white
-
-                            if ( static_cast< int >( current.position().first ) != 2 ) {
-                                return true;  // pawn has moved
-                            }
-
-                            bool piece_infront = game_board.at( pieces::rank_t( rank_val - 1 ) )
-                                                     .at( pieces::file_t( file_val ) )
-                                                     .piece.get();
-                            return piece_infront;
-                        }
-                        else {  // if it is black
-
-                            if ( static_cast< int >( current.position().first ) != 7 ) {
-                                return true;  // pawn has moved
-                            }
-
-                            bool piece_infront = game_board.at( pieces::rank_t( rank_val + 1 ) )
-                                                     .at( pieces::file_t( file_val ) )
-                                                     .piece.get();
-                            return piece_infront;
-                        }
-                    }
-                }
-            }
-            return false;
-        } );
-    }
+        bool colour = piece_colour( index );
 
-    void board::filter_knight_moves( space const & current, std::vector< space > & moves ) const
-    {
-        if ( !current.piece ) {
-            return;
+        switch ( piece_type( index ) ) {
+        case pieces::name_t::knight:
+            return knight_attacks[sq] & ~position.colour_bb[colour];
+        case pieces::name_t::king:
+            return king_attacks[sq] & ~position.colour_bb[colour];
+        case pieces::name_t::pawn:
+            return pawn_targets( sq, colour );
+        case pieces::name_t::bishop:
+            return bishop_attacks( sq, occupied ) & ~position.colour_bb[colour];
+        case pieces::name_t::rook:
+            return rook_attacks( sq, occupied ) & ~position.colour_bb[colour];
+        default:
+            return queen_attacks( sq, occupied ) & ~position.colour_bb[colour];
         }
-
-        auto x = std::erase_if( moves, [&current]( space const & move ) {
-            return move.piece && move.piece->colour() == current.piece->colour();
-        } );
     }
 
-    void board::filter_bishop_moves( space const & current, std::vector< space > & moves ) const
+    bitboard_t board::attacks_from( square_t const sq ) const
     {
-        auto rank_val = static_cast< int >( current.position().first );
-        auto file_val = static_cast< int >( current.position().second );
-
-        int left_boundary   = static_cast< int >( file_val ) - 1;
-        int right_boundary  = 8 - static_cast< int >( file_val );
-        int bottom_boundary = static_cast< int >( rank_val ) - 1;
-        int top_boundary    = 8 - static_cast< int >( rank_val );
-
-        std::vector< pieces::position_t > to_delete;
-
-        bool blocked = false;
-        for ( int i = 1; i <= right_boundary && i <= top_boundary; i++ ) {
-            if ( blocked ) {
-                auto const & space = game_board.at( static_cast< pieces::rank_t >( rank_val + i ) )
-                                         .at( static_cast< pieces::file_t >( file_val + i ) );
-                to_delete.push_back( space.position() );
-            }
-
-            auto const & piece = game_board.at( static_cast< pieces::rank_t >( rank_val + i ) )
-                                     .at( static_cast< pieces::file_t >( file_val + i ) )
-                                     .piece;
-
-            if ( piece ) {
-                // if the piece encountered is the same colour then we cant move there
-                if ( piece->colour() == current.piece->colour() ) {
-                    to_delete.push_back( piece->position() );
-                }
-                blocked = true;
-            }
+        auto index = position.mailbox[sq];
+        if ( index == no_piece ) {
+            return empty_bb;
         }
 
-        blocked = false;
-        for ( int i = 1; i <= left_boundary && i <= top_boundary; i++ ) {
-            if ( blocked ) {
-                auto const & space = game_board.at( static_cast< pieces::rank_t >( rank_val + i ) )
-                                         .at( static_cast< pieces::file_t >( file_val - i ) );
-                to_delete.push_back( space.position() );
-            }
-
-            auto const & piece = game_board.at( static_cast< pieces::rank_t >( rank_val + i ) )
-                                     .at( static_cast< pieces::file_t >( file_val - i ) )
-                                     .piece;
-
-            if ( piece ) {
-                // if the piece encountered is the same colour then we cant move there
-                if ( piece->colour() == current.piece->colour() ) {
-                    to_delete.push_back( piece->position() );
-                }
-                blocked = true;
-            }
-        }
-
-        blocked = false;
-        for ( int i = 1; i <= left_boundary && i <= bottom_boundary; i++ ) {
-            if ( blocked ) {
-                auto const & space = game_board.at( static_cast< pieces::rank_t >( rank_val - i ) )
-                                         .at( static_cast< pieces::file_t >( file_val - i ) );
-                to_delete.push_back( space.position() );
-            }
-
-            auto const & piece = game_board.at( static_cast< pieces::rank_t >( rank_val - i ) )
-                                     .at( static_cast< pieces::file_t >( file_val - i ) )
-                                     .piece;
+        auto occupied = occupancy();
 
-            if ( piece ) {
-                // if the piece encountered is the same colour then we cant move there
-                if ( piece->colour() == current.piece->colour() ) {
-                    to_delete.push_back( piece->position() );
-                }
-                blocked = true;
-            }
-        }
-
-        blocked = false;
-        for ( int i = 1; i <= right_boundary && i <= bottom_boundary; i++ ) {
-            if ( blocked ) {
-                auto const & space = game_board.at( static_cast< pieces::rank_t >( rank_val - i ) )
-                                         .at( static_cast< pieces::file_t >( file_val + i ) );
-                to_delete.push_back( space.position() );
-            }
-
-            auto const & piece = game_board.at( static_cast< pieces::rank_t >( rank_val - i ) )
-                                     .at( static_cast< pieces::file_t >( file_val + i ) )
-                                     .piece;
-
-            if ( piece ) {
-                // if the piece encountered is the same colour then we cant move there
-                if ( piece->colour() == current.piece->colour() ) {
-                    to_delete.push_back( piece->position() );
-                }
-                blocked = true;
-            }
+        switch ( piece_type( index ) ) {
+        case pieces::name_t::knight:
+            return knight_attacks[sq];
+        case pieces::name_t::king:
+            return king_attacks[sq];
+        case pieces::name_t::pawn:
+            return pawn_attacks[piece_colour( index )][sq];
+        case pieces::name_t::bishop:
+            return bishop_attacks( sq, occupied );
+        case pieces::name_t::rook:
+            return rook_attacks( sq, occupied );
+        default:
+            return queen_attacks( sq, occupied );
         }
-
-        // game class will handle check and castling logic
-        auto x = std::erase_if( moves, [&to_delete]( space const & move ) {
-            for ( auto del : to_delete ) {
-                if ( del == move ) {
-                    return true;
-                }
-            }
-            return false;
-        } );
     }
 
-    void board::filter_rook_moves( space const & current, std::vector< space > & moves ) const
+    bitboard_t board::attackers_to( square_t const sq, bool const colour, bitboard_t const blockers ) const
     {
-        auto rank_val = static_cast< int >( current.position().first );
-        auto file_val = static_cast< int >( current.position().second );
-
-        int left_boundary   = static_cast< int >( file_val ) - 1;
-        int right_boundary  = 8 - static_cast< int >( file_val );
-        int bottom_boundary = static_cast< int >( rank_val ) - 1;
-        int top_boundary    = 8 - static_cast< int >( rank_val );
-
-        std::vector< pieces::position_t > to_delete;
+        bitboard_t queens = piece_set( pieces::name_t::queen, colour );
 
-        bool blocked = false;
-        for ( int i = 1; i <= right_boundary; i++ ) {
-            if ( blocked ) {
-                auto const & space =
-                    game_board.at( current.position().first ).at( static_cast< pieces::file_t >( file_val + i ) );
-                to_delete.push_back( space.position() );
-            }
-
-            auto const & piece =
-                game_board.at( current.position().first ).at( static_cast< pieces::file_t >( file_val + i ) ).piece;
-
-            if ( piece ) {
-                // if the piece encountered is the same colour then we cant move there
-                if ( piece->colour() == current.piece->colour() ) {
-                    to_delete.push_back( piece->position() );
-                }
-                blocked = true;
-            }
-        }
-
-        blocked = false;
-        for ( int i = 1; i <= left_boundary; i++ ) {
-            if ( blocked ) {
-                auto const & space =
-                    game_board.at( current.position().first ).at( static_cast< pieces::file_t >( file_val - i ) );
-                to_delete.push_back( space.position() );
-            }
+        return ( pawn_attacks[!colour][sq] & piece_set( pieces::name_t::pawn, colour ) ) |
+               ( knight_attacks[sq] & piece_set( pieces::name_t::knight, colour ) ) |
+               ( king_attacks[sq] & piece_set( pieces::name_t::king, colour ) ) |
+               ( bishop_attacks( sq, blockers ) & ( piece_set( pieces::name_t::bishop, colour ) | queens ) ) |
+               ( rook_attacks( sq, blockers ) & ( piece_set( pieces::name_t::rook, colour ) | queens ) );
+    }
 
-            auto const & piece =
-                game_board.at( current.position().first ).at( static_cast< pieces::file_t >( file_val - i ) ).piece;
+    void board::remove_piece_at( pieces::position_t const position ) { take_piece( to_square( position ) ); }
 
-            if ( piece ) {
-                // if the piece encountered is the same colour then we cant move there
-                if ( piece->colour() == current.piece->colour() ) {
-                    to_delete.push_back( piece->position() );
-                }
-                blocked = true;
-            }
-        }
-
-        blocked = false;
-        for ( int i = 1; i <= top_boundary; i++ ) {
-            if ( blocked ) {
-                auto const & space =
-                    game_board.at( static_cast< pieces::rank_t >( rank_val + i ) ).at( current.position().second );
-                to_delete.push_back( space.position() );
-            }
+    void board::add_piece_at( pieces::piece const & p, pieces::position_t const position )
+    {
+        put_piece( to_square( position ), make_piece_index( p.type(), p.colour() ) );
+    }
 
-            auto const & piece =
-                game_board.at( static_cast< pieces::rank_t >( rank_val + i ) ).at( current.position().second ).piece;
+    std::vector< std::string > const & board::get_move_history() const { return cold.move_history; }
 
-            if ( piece ) {
-                // if the piece encountered is the same colour then we cant move there
-                if ( piece->colour() == current.piece->colour() ) {
-                    to_delete.push_back( piece->position() );
-                }
-                blocked = true;
-            }
+    bitboard_t board::pawn_targets( square_t const sq, bool const white ) const
+    {
+        // pawn on the back rank
+        if ( rank_of( sq ) == 1 || rank_of( sq ) == 8 ) {
+            return empty_bb;
         }
 
-        blocked = false;
-        for ( int i = 1; i <= bottom_boundary; i++ ) {
-            if ( blocked ) {
-                auto const & space =
-                    game_board.at( static_cast< pieces::rank_t >( rank_val - i ) ).at( current.position().second );
-                to_delete.push_back( space.position() );
-            }
+        auto       occupied = occupancy();
+        bitboard_t targets  = pawn_attacks[white][sq] & position.colour_bb[!white];
 
-            auto const & piece =
-                game_board.at( static_cast< pieces::rank_t >( rank_val - i ) ).at( current.position().second ).piece;
+        square_t forward = white ? sq + 8 : sq - 8;
+        if ( !is_set( occupied, forward ) ) {
+            targets |= square_bb( forward );
 
-            if ( piece ) {
-                // if the piece encountered is the same colour then we cant move there
-                if ( piece->colour() == current.piece->colour() ) {
-                    to_delete.push_back( piece->position() );
-                }
-                blocked = true;
+            // first move
+            square_t double_push = white ? sq + 16 : sq - 16;
+            if ( rank_of( sq ) == ( white ? 2 : 7 ) && !is_set( occupied, double_push ) ) {
+                targets |= square_bb( double_push );
             }
         }
 
-        // game class will handle check and castling logic
-        auto x = std::erase_if( moves, [&to_delete]( space const & move ) {
-            for ( auto del : to_delete ) {
-                if ( del == move ) {
-                    return true;
-                }
-            }
-            return false;
-        } );
-    }
-    void board::filter_queen_moves( space const & current, std::vector< space > & moves ) const
-    {
-        filter_rook_moves( current, moves );
-        filter_bishop_moves( current, moves );
-    }
-    void board::filter_king_moves( space const & current, std::vector< space > & moves ) const
-    {
-        // game class will handle check and castling logic
-        auto x = std::erase_if( moves, [&current]( space const & move ) {
-            return move.piece && move.piece->colour() == current.piece->colour();
-        } );
+        return targets;
     }
 
     void board::add_pawn_attacks( space const & current, std::vector< pieces::position_t > & moves ) const
     {
-        int rank = static_cast< int >( current.position().first );
-        int file = static_cast< int >( current.position().second );
-        if ( current.piece->colour() ) {
-            if ( rank < 8 && file - 1 >= 1 ) {
-                moves.push_back( pieces::piece::itopos( rank + 1, file - 1 ).value() );
-            }
-            if ( rank < 8 && file + 1 <= 8 ) {
-                moves.push_back( pieces::piece::itopos( rank + 1, file + 1 ).value() );
-            }
-        }
-        else {
-            if ( rank > 1 && file - 1 >= 1 ) {
-                moves.push_back( pieces::piece::itopos( rank - 1, file - 1 ).value() );
-            }
-            if ( rank > 1 && file + 1 <= 8 ) {
-                moves.push_back( pieces::piece::itopos( rank - 1, file + 1 ).value() );
-            }
+        auto targets = pawn_attacks[current.piece->colour()][to_square( current.position() )];
+        while ( targets ) {
+            moves.push_back( to_position( pop_lsb( targets ) ) );
         }
     }
+
     void board::add_knight_attacks( space const & current, std::vector< pieces::position_t > & moves ) const
     {
-        int rank = static_cast< int >( current.position().first );
-        int file = static_cast< int >( current.position().second );
-
-        if ( rank - 2 >= 1 ) {
-            if ( file - 1 >= 1 ) {
-                moves.push_back( pieces::piece::itopos( rank - 2, file - 1 ).value() );
-            }
-            if ( file + 1 <= 8 ) {
-                moves.push_back( pieces::piece::itopos( rank - 2, file + 1 ).value() );
-            }
-        }
-        if ( rank + 2 <= 8 ) {
-            if ( file - 1 >= 1 ) {
-                moves.push_back( pieces::piece::itopos( rank + 2, file - 1 ).value() );
-            }
-            if ( file + 1 <= 8 ) {
-                moves.push_back( pieces::piece::itopos( rank + 2, file + 1 ).value() );
-            }
-        }
-
-        if ( file - 2 >= 1 ) {
-            if ( rank - 1 >= 1 ) {
-                moves.push_back( pieces::piece::itopos( rank - 1, file - 2 ).value() );
-            }
-            if ( rank + 1 <= 8 ) {
-                moves.push_back( pieces::piece::itopos( rank + 1, file - 2 ).value() );
-            }
-        }
-        if ( file + 2 <= 8 ) {
-            if ( rank - 1 >= 1 ) {
-                moves.push_back( pieces::piece::itopos( rank - 1, file + 2 ).value() );
-            }
-            if ( rank + 1 <= 8 ) {
-                moves.push_back( pieces::piece::itopos( rank + 1, file + 2 ).value() );
-            }
+        auto targets = knight_attacks[to_square( current.position() )];
+        while ( targets ) {
+            moves.push_back( to_position( pop_lsb( targets ) ) );
         }
     }
 
     void board::add_bishop_attacks( space const & current, std::vector< pieces::position_t > & moves ) const
     {
-        int rank_val = static_cast< int >( current.position().first );
-        int file_val = static_cast< int >( current.position().second );
-
-        for ( int rank = rank_val - 1, file = file_val - 1; rank >= 1 && file >= 1; rank--, file-- ) {
-            auto const & space =
-                game_board.at( static_cast< pieces::rank_t >( rank ) ).at( static_cast< pieces::file_t >( file ) );
-            moves.push_back( space.position() );
-
-            if ( space.piece ) {
-                break;
-            }
-        }
-
-        for ( int rank = rank_val - 1, file = file_val + 1; rank >= 1 && file <= 8; rank--, file++ ) {
-            auto const & space =
-                game_board.at( static_cast< pieces::rank_t >( rank ) ).at( static_cast< pieces::file_t >( file ) );
-            moves.push_back( space.position() );
-
-            if ( space.piece ) {
-                break;
-            }
-        }
-
-        for ( int rank = rank_val + 1, file = file_val - 1; rank <= 8 && file >= 1; rank++, file-- ) {
-            auto const & space =
-                game_board.at( static_cast< pieces::rank_t >( rank ) ).at( static_cast< pieces::file_t >( file ) );
-            moves.push_back( space.position() );
-
-            if ( space.piece ) {
-                break;
-            }
-        }
-
-        for ( int rank = rank_val + 1, file = file_val + 1; rank <= 8 && file <= 8; rank++, file++ ) {
-            auto const & space =
-                game_board.at( static_cast< pieces::rank_t >( rank ) ).at( static_cast< pieces::file_t >( file ) );
-            moves.push_back( space.position() );
-
-            if ( space.piece ) {
-                break;
-            }
+        auto targets = bishop_attacks( to_square( current.position() ), occupancy() );
+        while ( targets ) {
+            moves.push_back( to_position( pop_lsb( targets ) ) );
         }
     }
 
     void board::add_rook_attacks( space const & current, std::vector< pieces::position_t > & moves ) const
     {
-        int rank_val = static_cast< int >( current.position().first );
-        int file_val = static_cast< int >( current.position().second );
-
-        for ( int rank = rank_val - 1; rank >= 1; rank-- ) {
-            auto const & space =
-                game_board.at( static_cast< pieces::rank_t >( rank ) ).at( static_cast< pieces::file_t >( file_val ) );
-            moves.push_back( space.position() );
-
-            if ( space.piece ) {
-                break;
-            }
-        }
-
-        for ( int rank = rank_val + 1; rank <= 8; rank++ ) {
-            auto const & space =
-                game_board.at( static_cast< pieces::rank_t >( rank ) ).at( static_cast< pieces::file_t >( file_val ) );
-            moves.push_back( space.position() );
-
-            if ( space.piece ) {
-                break;
-            }
-        }
-
-        for ( int file = file_val - 1; file >= 1; file-- ) {
-            auto const & space =
-                game_board.at( static_cast< pieces::rank_t >( rank_val ) ).at( static_cast< pieces::file_t >( file ) );
-            moves.push_back( space.position() );
-
-            if ( space.piece ) {
-                break;
-            }
-        }
-
-        for ( int file = file_val + 1; file <= 8; file++ ) {
-            auto const & space =
-                game_board.at( static_cast< pieces::rank_t >( rank_val ) ).at( static_cast< pieces::file_t >( file ) );
-            moves.push_back( space.position() );
-
-            if ( space.piece ) {
-                break;
-            }
+        auto targets = rook_attacks( to_square( current.position() ), occupancy() );
+        while ( targets ) {
+            moves.push_back( to_position( pop_lsb( targets ) ) );
         }
     }
+
     void board::add_queen_attacks( space const & current, std::vector< pieces::position_t > & moves ) const
     {
-        add_rook_attacks( current, moves );
-        add_bishop_attacks( current, moves );
+        auto targets = queen_attacks( to_square( current.position() ), occupancy() );
+        while ( targets ) {
+            moves.push_back( to_position( pop_lsb( targets ) ) );
+        }
     }
+
     void board::add_king_attacks( space const & current, std::vector< pieces::position_t > & moves ) const
     {
-        int rank = static_cast< int >( current.position().first );
-        int file = static_cast< int >( current.position().second );
-
-        if ( rank - 1 >= 1 ) {
-            if ( file - 1 >= 1 ) {
-                moves.push_back( pieces::piece::itopos( rank - 1, file - 1 ).value() );
-            }
-            if ( file + 1 <= 8 ) {
-                moves.push_back( pieces::piece::itopos( rank - 1, file + 1 ).value() );
-            }
-            moves.push_back( pieces::piece::itopos( rank - 1, file ).value() );
-        }
-        if ( rank + 1 <= 8 ) {
-            if ( file - 1 >= 1 ) {
-                moves.push_back( pieces::piece::itopos( rank + 1, file - 1 ).value() );
-            }
-            if ( file + 1 <= 8 ) {
-                moves.push_back( pieces::piece::itopos( rank + 1, file + 1 ).value() );
-            }
-            moves.push_back( pieces::piece::itopos( rank + 1, file ).value() );
-        }
-
-        if ( file - 1 >= 1 ) {
-            moves.push_back( pieces::piece::itopos( rank, file - 1 ).value() );
-        }
-        if ( file + 1 <= 8 ) {
-            moves.push_back( pieces::piece::itopos( rank, file + 1 ).value() );
+        auto targets = king_attacks[to_square( current.position() )];
+        while ( targets ) {
+            moves.push_back( to_position( pop_lsb( targets ) ) );
         }
     }
 
@@ -792,15 +665,25 @@ namespace chess::game {
         return positions;
     }
 
-    space const & board::get( pieces::position_t pos ) const
-    {  //
-        try {
-            return game_board.at( pos.first ).at( pos.second );
-        }
-        catch ( std::exception const & e ) {
+    space board::get( pieces::position_t pos ) const
+    {
+        auto rank = static_cast< int >( pos.first );
+        auto file = static_cast< int >( pos.second );
+
+        if ( rank < 1 || rank > 8 || file < 1 || file > 8 ) {
             std::cout << "Error Getting Position: " << pieces::to_string( pos ) << "\n";
-            throw e;
+            throw std::out_of_range( "Invalid board position" );
         }
+
+        return get( make_square( rank, file ) );
+    }
+
+    space board::get( square_t const sq ) const
+    {
+        // the copy is taken before the lock is let go, a later sync may replace the piece in the space
+        std::lock_guard< std::mutex > lock( cold.squares_mutex );
+        sync_space( sq );
+        return cold.squares[sq];
     }
 
     std::string board::to_string() const
@@ -810,10 +693,7 @@ namespace chess::game {
         for ( int i = 8; i > 0; i-- ) {
             serialized << i << "\t|";
             for ( int j = 1; j <= 8; j++ ) {
-                auto rank = static_cast< pieces::rank_t >( i );
-                auto file = static_cast< pieces::file_t >( j );
-
-                space const & current_space = game_board.at( rank ).at( file );
+                space const current_space = get( make_square( i, j ) );
 
                 if ( current_space.piece ) {
                     char piece_icon;
@@ -867,87 +747,15 @@ namespace chess::game {
 
     void board::place_pieces()
     {
+        constexpr pieces::name_t back_rank[8] = { pieces::name_t::rook,   pieces::name_t::knight, pieces::name_t::bishop,
+                                                  pieces::name_t::queen,  pieces::name_t::king,   pieces::name_t::bishop,
+                                                  pieces::name_t::knight, pieces::name_t::rook };
 
-        auto rank   = static_cast< pieces::rank_t >( 1 );
-        bool colour = true;
-        for ( int j = 1; j <= 8; j++ ) {
-            auto file = static_cast< pieces::file_t >( j );
-
-            switch ( file ) {
-            case pieces::file_t::a:
-                game_board.at( rank ).at( file ).piece = std::make_unique< pieces::rook >( colour, rank, file );
-                break;
-            case pieces::file_t::b:
-                game_board.at( rank ).at( file ).piece = std::make_unique< pieces::knight >( colour, rank, file );
-                break;
-            case pieces::file_t::c:
-                game_board.at( rank ).at( file ).piece = std::make_unique< pieces::bishop >( colour, rank, file );
-                break;
-            case pieces::file_t::d:
-                game_board.at( rank ).at( file ).piece = std::make_unique< pieces::queen >( colour, rank, file );
-                break;
-            case pieces::file_t::e:
-                game_board.at( rank ).at( file ).piece = std::make_unique< pieces::king >( colour, rank, file );
-                break;
-            case pieces::file_t::f:
-                game_board.at( rank ).at( file ).piece = std::make_unique< pieces::bishop >( colour, rank, file );
-                break;
-            case pieces::file_t::g:
-                game_board.at( rank ).at( file ).piece = std::make_unique< pieces::knight >( colour, rank, file );
-                break;
-            case pieces::file_t::h:
-                game_board.at( rank ).at( file ).piece = std::make_unique< pieces::rook >( colour, rank, file );
-                break;
-            }
-        }
-
-        colour = false;
-        rank   = static_cast< pieces::rank_t >( 8 );
         for ( int j = 1; j <= 8; j++ ) {
-            auto file = static_cast< pieces::file_t >( j );
-
-            switch ( file ) {
-            case pieces::file_t::a:
-                game_board.at( rank ).at( file ).piece = std::make_unique< pieces::rook >( colour, rank, file );
-                break;
-            case pieces::file_t::b:
-                game_board.at( rank ).at( file ).piece = std::make_unique< pieces::knight >( colour, rank, file );
-                break;
-            case pieces::file_t::c:
-                game_board.at( rank ).at( file ).piece = std::make_unique< pieces::bishop >( colour, rank, file );
-                break;
-            case pieces::file_t::d:
-                game_board.at( rank ).at( file ).piece = std::make_unique< pieces::queen >( colour, rank, file );
-                break;
-            case pieces::file_t::e:
-                game_board.at( rank ).at( file ).piece = std::make_unique< pieces::king >( colour, rank, file );
-                break;
-            case pieces::file_t::f:
-                game_board.at( rank ).at( file ).piece = std::make_unique< pieces::bishop >( colour, rank, file );
-                break;
-            case pieces::file_t::g:
-                game_board.at( rank ).at( file ).piece = std::make_unique< pieces::knight >( colour, rank, file );
-                break;
-            case pieces::file_t::h:
-                game_board.at( rank ).at( file ).piece = std::make_unique< pieces::rook >( colour, rank, file );
-                break;
-            }
-        }
-
-        rank   = static_cast< pieces::rank_t >( 2 );
-        colour = true;
-        for ( int j = 1; j <= 8; j++ ) {
-            auto file = static_cast< pieces::file_t >( j );
-
-            game_board.at( rank ).at( file ).piece = std::make_unique< pieces::pawn >( colour, rank, file );
-        }
-
-        colour = false;
-        rank   = static_cast< pieces::rank_t >( 7 );
-        for ( int j = 1; j <= 8; j++ ) {
-            auto file = static_cast< pieces::file_t >( j );
-
-            game_board.at( rank ).at( file ).piece = std::make_unique< pieces::pawn >( colour, rank, file );
+            put_piece( make_square( 1, j ), make_piece_index( back_rank[j - 1], true ) );
+            put_piece( make_square( 2, j ), white_pawn );
+            put_piece( make_square( 7, j ), black_pawn );
+            put_piece( make_square( 8, j ), make_piece_index( back_rank[j - 1], false ) );
         }
     }
 
@@ -959,19 +767,16 @@ namespace chess::game {
         }
 
         // copy the board
-        board board( to_string() );
+        board board( *this );
 
         // force the move on the copied board (src to dst)
-        board[dst.position().first].at( dst.position().second ).piece = src.piece->copy_piece();
-        if ( board[dst.position().first].at( dst.position().second ).piece ) {
-            board[dst.position().first].at( dst.position().second ).piece->place( src.position() );
-        }
-        board[src.position().first].at( src.position().second ).piece.reset();
+        board.put_piece( to_square( dst.position() ), make_piece_index( src.piece->type(), src.piece->colour() ) );
+        board.take_piece( to_square( src.position() ) );
 
         for ( int i = 1; i <= 8; i++ ) {
             for ( int j = 1; j <= 8; j++ ) {
                 auto          pos = pieces::piece::itopos( i, j ).value();
-                space const & sp  = board.get( pos );
+                space const   sp  = board.get( pos );
                 // if sp has a piece that is a valid attacker
                 if ( sp.piece && sp.piece->colour() != victim_colour ) {
                     auto possible_moves = board.possible_moves( sp );
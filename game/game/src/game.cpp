@@ -1,81 +1,171 @@
 #include "space.hpp"
 #include <algorithm>
+#include <array>
+#include <attacks.hpp>
 #include <board.hpp>
 #include <cassert>
-#include <chrono>
+#include <charconv>
 #include <game.hpp>
 #include <iostream>
 #include <ostream>
 #include <piece.hpp>
 #include <stdexcept>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace chess {
 
-    void chess_game::color_attack_map::clear()
-    {
-        num_attackers = 0;
-        attacker_spaces.clear();
-    }
+    namespace {
+        constexpr std::string_view whitespace = " \t\r\n";
 
-    void chess_game::color_attack_map::add_attacker( pieces::position_t attacker )
-    {
-        num_attackers++;
-        attacker_spaces.push_back( attacker );
-    }
+        // splits the next whitespace separated field off the front of a FEN or EPD record, empty once none are left
+        std::string_view next_field( std::string_view & record )
+        {
+            auto start = record.find_first_not_of( whitespace );
+            if ( start == std::string_view::npos ) {
+                record = {};
+                return {};
+            }
 
-    void chess_game::color_attack_map::remove_attacker( pieces::position_t attacker )
-    {
-        num_attackers--;
-        std::erase( attacker_spaces, attacker );
-    }
+            record.remove_prefix( start );
 
-    std::string chess_game::color_attack_map::to_string() const { return std::to_string( num_attackers ); }
+            auto end   = std::min( record.find_first_of( whitespace ), record.size() );
+            auto field = record.substr( 0, end );
+            record.remove_prefix( end );
+            return field;
+        }
 
-    void chess_game::attack_map::clear()
-    {
-        for ( int i = 0; i < 8; i++ ) {
-            for ( int j = 0; j < 8; j++ ) {
-                white_attack_map[i][j].clear();
-                black_attack_map[i][j].clear();
+        // a missing clock keeps its default
+        bool parse_clock( std::string_view const field, int & value )
+        {
+            if ( field.empty() ) {
+                return true;
             }
+
+            auto [end, error] = std::from_chars( field.data(), field.data() + field.size(), value );
+            return error == std::errc() && end == field.data() + field.size() && value >= 0;
+        }
+
+        // castling rights lost when a piece leaves or lands on each square
+        constexpr std::array< std::uint8_t, game::num_squares > castling_masks = []() {
+            std::array< std::uint8_t, game::num_squares > masks{};
+            masks[game::make_square( 1, 5 )] = game::white_king_side | game::white_queen_side;
+            masks[game::make_square( 1, 1 )] = game::white_queen_side;
+            masks[game::make_square( 1, 8 )] = game::white_king_side;
+            masks[game::make_square( 8, 5 )] = game::black_king_side | game::black_queen_side;
+            masks[game::make_square( 8, 1 )] = game::black_queen_side;
+            masks[game::make_square( 8, 8 )] = game::black_king_side;
+            return masks;
+        }();
+
+        // the piece each castling right needs on its home square, the rights are cleared as castling_masks has them
+        constexpr std::array< std::pair< game::square_t, game::piece_index >, 6 > castling_homes = { {
+            { game::make_square( 1, 5 ), game::white_king },
+            { game::make_square( 1, 1 ), game::white_rook },
+            { game::make_square( 1, 8 ), game::white_rook },
+            { game::make_square( 8, 5 ), game::black_king },
+            { game::make_square( 8, 1 ), game::black_rook },
+            { game::make_square( 8, 8 ), game::black_rook },
+        } };
+
+        // bishops and queens of both colours
+        game::bitboard_t diagonal_sliders( game::board const & b )
+        {
+            return b.piece_set( game::white_bishop ) | b.piece_set( game::black_bishop ) |
+                   b.piece_set( game::white_queen ) | b.piece_set( game::black_queen );
+        }
+
+        // rooks and queens of both colours
+        game::bitboard_t straight_sliders( game::board const & b )
+        {
+            return b.piece_set( game::white_rook ) | b.piece_set( game::black_rook ) |
+                   b.piece_set( game::white_queen ) | b.piece_set( game::black_queen );
         }
+    }  // namespace
+
+    void chess_game::attack_map::clear()
+    {
+        std::fill( &attackers[0][0], &attackers[0][0] + 2 * game::num_squares, game::empty_bb );
+        std::fill( std::begin( attacks_from ), std::end( attacks_from ), game::empty_bb );
+        sources[0] = sources[1] = game::empty_bb;
     }
 
-    void chess_game::attack_map::add_attacker( game::space const &        attacker,
-                                               pieces::position_t const & position_attacked )
+    void chess_game::attack_map::update( game::board const & b, game::bitboard_t const changed )
     {
-        if ( !attacker.piece ) {
-            return;
+        auto occupied = b.occupancy();
+        auto diagonal = diagonal_sliders( b );
+        auto straight = straight_sliders( b );
+
+        // a slider's attacks only change if it reached a changed square before the update or reaches one now
+        auto affected = changed;
+        for ( auto bb = changed; bb; ) {
+            auto sq = game::pop_lsb( bb );
+            affected |= ( attackers[0][sq] | attackers[1][sq] ) & ( diagonal | straight );
+            affected |= ( game::bishop_attacks( sq, occupied ) & diagonal ) |
+                        ( game::rook_attacks( sq, occupied ) & straight );
         }
 
-        int rank = static_cast< int >( position_attacked.first );
-        int file = static_cast< int >( position_attacked.second );
+        for ( auto bb = affected; bb; ) {
+            auto sq = game::pop_lsb( bb );
 
-        if ( attacker.piece->colour() ) {
-            white_attack_map[rank - 1][file - 1].add_attacker( position_attacked );
-        }
-        else {
-            black_attack_map[rank - 1][file - 1].add_attacker( position_attacked );
+            for ( int colour = 0; colour < 2; colour++ ) {
+                if ( !game::is_set( sources[colour], sq ) ) {
+                    continue;
+                }
+
+                for ( auto targets = attacks_from[sq]; targets; ) {
+                    attackers[colour][game::pop_lsb( targets )] &= ~game::square_bb( sq );
+                }
+                sources[colour] &= ~game::square_bb( sq );
+            }
+
+            auto index       = b.piece_on( sq );
+            attacks_from[sq] = b.attacks_from( sq );
+            if ( index == game::no_piece ) {
+                continue;
+            }
+
+            bool colour = game::piece_colour( index );
+            for ( auto targets = attacks_from[sq]; targets; ) {
+                attackers[colour][game::pop_lsb( targets )] |= game::square_bb( sq );
+            }
+            sources[colour] |= game::square_bb( sq );
         }
     }
 
-    void chess_game::attack_map::remove_attacker( game::space const &        attacker,
-                                                  pieces::position_t const & position_attacked )
+    void chess_game::attack_map::rebuild( game::board const & b )
     {
-        if ( !attacker.piece ) {
-            return;
-        }
+        clear();
 
-        int rank = static_cast< int >( position_attacked.first );
-        int file = static_cast< int >( position_attacked.second );
+        auto occupied = b.occupancy();
 
-        if ( attacker.piece->colour() ) {
-            white_attack_map[rank - 1][file - 1].remove_attacker( position_attacked );
-        }
-        else {
-            black_attack_map[rank - 1][file - 1].remove_attacker( position_attacked );
+        // nothing is counted yet, so each piece only adds its own attacks
+        for ( int colour = 0; colour < 2; colour++ ) {
+            sources[colour] = b.colour_set( colour );
+
+            auto count = [&]( game::bitboard_t pieces, auto const attacks ) {
+                while ( pieces ) {
+                    auto sq          = game::pop_lsb( pieces );
+                    attacks_from[sq] = attacks( sq );
+                    for ( auto targets = attacks_from[sq]; targets; ) {
+                        attackers[colour][game::pop_lsb( targets )] |= game::square_bb( sq );
+                    }
+                }
+            };
+
+            count( b.piece_set( pieces::name_t::pawn, colour ),
+                   [colour]( game::square_t sq ) { return game::pawn_attacks[colour][sq]; } );
+            count( b.piece_set( pieces::name_t::knight, colour ),
+                   []( game::square_t sq ) { return game::knight_attacks[sq]; } );
+            count( b.piece_set( pieces::name_t::bishop, colour ),
+                   [occupied]( game::square_t sq ) { return game::bishop_attacks( sq, occupied ); } );
+            count( b.piece_set( pieces::name_t::rook, colour ),
+                   [occupied]( game::square_t sq ) { return game::rook_attacks( sq, occupied ); } );
+            count( b.piece_set( pieces::name_t::queen, colour ),
+                   [occupied]( game::square_t sq ) { return game::queen_attacks( sq, occupied ); } );
+            count( b.piece_set( pieces::name_t::king, colour ),
+                   []( game::square_t sq ) { return game::king_attacks[sq]; } );
         }
     }
 
@@ -87,30 +177,22 @@ namespace chess {
 
     int chess_game::attack_map::num_attackers( game::space const & s, bool color ) const
     {
-        int rank = static_cast< int >( s.position().first );
-        int file = static_cast< int >( s.position().second );
-
-        if ( color ) {
-            return white_attack_map[rank - 1][file - 1].num_attackers;
-        }
-        else {
-            return black_attack_map[rank - 1][file - 1].num_attackers;
-        }
+        return game::popcount( attackers[color][game::to_square( s.position() )] );
     }
 
     std::string chess_game::attack_map::to_string() const
     {
         std::string output = "White Attack Map:\n";
-        for ( int i = 0; i < 8; i++ ) {
-            for ( int j = 0; j < 8; j++ ) {
-                output += white_attack_map[7 - i][j].to_string() + " ";
+        for ( int rank = 8; rank >= 1; rank-- ) {
+            for ( int file = 1; file <= 8; file++ ) {
+                output += std::to_string( game::popcount( attackers[1][game::make_square( rank, file )] ) ) + " ";
             }
             output += "\n";
         }
         output += "\nBlack Attack Map\n";
-        for ( int i = 0; i < 8; i++ ) {
-            for ( int j = 0; j < 8; j++ ) {
-                output += black_attack_map[7 - i][j].to_string() + " ";
+        for ( int rank = 8; rank >= 1; rank-- ) {
+            for ( int file = 1; file <= 8; file++ ) {
+                output += std::to_string( game::popcount( attackers[0][game::make_square( rank, file )] ) ) + " ";
             }
             output += "\n";
         }
@@ -119,193 +201,326 @@ namespace chess {
         return output;
     }
 
-    chess_game::chess_game() :
-        game_board(),
-        white_king( *reinterpret_cast< pieces::king * >(
-            game_board.get( pieces::piece::itopos( 1, 5 ).value() ).piece.get() ) ),
-        black_king(
-            *reinterpret_cast< pieces::king * >( game_board.get( pieces::piece::itopos( 8, 5 ).value() ).piece.get() ) )
-    {
-        start();
-    }
+    chess_game::chess_game() : game_board() { start(); }
 
-    chess_game::chess_game( std::string const & board_state ) :
-        game_board(),
-        white_king( *reinterpret_cast< pieces::king * >(
-            game_board.get( pieces::piece::itopos( 1, 5 ).value() ).piece.get() ) ),
-        black_king(
-            *reinterpret_cast< pieces::king * >( game_board.get( pieces::piece::itopos( 8, 5 ).value() ).piece.get() ) )
-    {
-        load_from_string( board_state );
-    }
+    chess_game::chess_game( std::string const & board_state ) : game_board() { load_from_string( board_state ); }
 
     void chess_game::start()
     {
-        state = game_state::white_move;
         game_board.reset();
-        king_side_castle_white  = true;
-        king_side_castle_black  = true;
-        queen_side_castle_white = true;
-        queen_side_castle_black = true;
-
-        white_king =
-            *reinterpret_cast< pieces::king * >( game_board.get( pieces::piece::itopos( 1, 5 ).value() ).piece.get() );
-        black_king =
-            *reinterpret_cast< pieces::king * >( game_board.get( pieces::piece::itopos( 8, 5 ).value() ).piece.get() );
+        position().castling = game::white_king_side | game::white_queen_side | game::black_king_side |
+                              game::black_queen_side;
+        position().key ^= compute_state_key();
+        undo_stack.clear();
+
         update_attack_map();
     }
 
     bool chess_game::checkmate( bool const colour ) const
     {
-        std::vector< game::space > moves;
-        moves.reserve( 64 );
-        game::board board_copy = game_board;
-
-        for ( int i = 1; i <= 8; i++ ) {
-            for ( int j = 1; j <= 8; j++ ) {
-                auto & src = board_copy.get( pieces::piece::itopos( i, j ).value() );
-                if ( src.piece && src.piece->colour() == colour ) {
-                    possible_moves( board_copy, src, moves );
-                    if ( !moves.empty() ) {
-                        return false;
-                    }
-                }
+        // only the side to move has moves
+        if ( colour ? !white_move() : !black_move() ) {
+            return true;
+        }
+
+        return !has_legal_move( colour );
+    }
+
+    bool chess_game::has_legal_move( bool const colour ) const
+    {
+        auto info = legality( colour );
+
+        // king moves first, they are all there is in double check. castling needs the square next to the king to be
+        // empty and safe, so a side that can castle always has a king move as well
+        if ( info.king != game::num_squares && legal_targets( info.king, info ) ) {
+            return true;
+        }
+
+        if ( !info.evasions ) {
+            return false;
+        }
+
+        auto others = game_board.colour_set( colour ) & ~game_board.piece_set( pieces::name_t::king, colour );
+        while ( others ) {
+            if ( legal_targets( game::pop_lsb( others ), info ) ) {
+                return true;
             }
         }
-        return true;
+
+        return false;
     }
 
-    pieces::move_status chess_game::move( game::space const & src, game::space const & dst )
+    bool chess_game::gives_check( move_t const & move ) const
     {
-        if ( !src.piece ) {
-            return pieces::move_status::no_piece_to_move;
+        auto src = move.from();
+        auto dst = move.to();
+
+        auto moved  = game_board.piece_on( dst );
+        bool colour = game::piece_colour( moved );
+        auto king   = king_square( !colour );
+        if ( king == game::num_squares ) {
+            return false;
+        }
+
+        // the piece that moved, a promoted pawn already being the new piece
+        if ( game::is_set( game_board.attacks_from( dst ), king ) ) {
+            return true;
+        }
+
+        auto occupied = game_board.occupancy();
+
+        // the rook that castled
+        if ( game::piece_type( moved ) == pieces::name_t::king && ( dst - src == 2 || src - dst == 2 ) ) {
+            auto rook = game::make_square( game::rank_of( src ), dst > src ? 6 : 4 );
+            return game::is_set( game::rook_attacks( rook, occupied ), king );
+        }
+
+        // a slider behind the square the piece left
+        if ( !game::line_bb[king][src] ) {
+            return false;
         }
 
-        // deep copy
-        auto src_piece_cpy = src.piece->copy_piece();
+        auto queens   = game_board.piece_set( pieces::name_t::queen, colour );
+        auto diagonal = game_board.piece_set( pieces::name_t::bishop, colour ) | queens;
+        auto straight = game_board.piece_set( pieces::name_t::rook, colour ) | queens;
+        auto sliders  = ( game::bishop_attacks( king, occupied ) & diagonal ) |
+                       ( game::rook_attacks( king, occupied ) & straight );
 
-        std::vector< game::space > pos;
-        auto                       board_cpy = game_board;
-        auto                       status    = possible_moves( board_cpy, src, pos );
+        return sliders & game::line_bb[king][src];
+    }
 
+    pieces::move_status chess_game::move( game::space const & src, game::space const & dst )
+    {
+        auto status = validate_turn( src );
         if ( status != pieces::move_status::valid ) {
             return status;
         }
 
-        if ( pos.empty() || std::find( pos.begin(), pos.end(), dst ) == pos.end() ) {
+        auto m = to_move( game::to_square( src.position() ), game::to_square( dst.position() ) );
+        if ( !is_pseudo_legal( m ) || !is_legal( m ) ) {
             return pieces::move_status::illegal_move;
         }
 
-        auto copy_dst = dst.position();
-        status        = game_board.move( src.position(), dst.position() );
-        update_attack_map();
+        status = make_move( m );
 
-        if ( status != pieces::move_status::valid ) {
-            return status;
+        if ( get_state() == game_state::white_wins ) {
+            std::cout << "White Wins\n";
+        }
+        else if ( get_state() == game_state::black_wins ) {
+            std::cout << "Black Wins\n";
         }
 
-        try {
-            if ( white_move() ) {
-                if ( game_attack_map.has_attackers( game_board.get( black_king.get().position() ), true ) ) {
-                    state = game_state::black_check;
-                    if ( checkmate( false ) ) {
-                        std::cout << "White Wins\n";
-                        state = game_state::white_wins;
-                    }
-                }
-                else {
-                    state = game_state::black_move;
-                }
+        return status;
+    }
 
-                white_castling_rights( src_piece_cpy, src.position() );
+    move_t chess_game::to_move( game::square_t const src, game::square_t const dst ) const
+    {
+        auto type = game::piece_type( game_board.piece_on( src ) );
 
-                if ( dst == pieces::piece::itopos( 8, 1 ) ) {
-                    queen_side_castle_black = false;
-                }
-                else if ( dst == pieces::piece::itopos( 8, 8 ) ) {
-                    king_side_castle_black = false;
-                }
+        if ( type == pieces::name_t::king && ( dst - src == 2 || src - dst == 2 ) ) {
+            return { src, dst, game::move_flag::castling };
+        }
+        if ( type == pieces::name_t::pawn && ( game::rank_of( dst ) == 1 || game::rank_of( dst ) == 8 ) ) {
+            return { src, dst, game::move_flag::promotion, pieces::name_t::queen };
+        }
+        return { src, dst };
+    }
+
+    bool chess_game::is_pseudo_legal( move_t const & move ) const
+    {
+        if ( !white_move() && !black_move() ) {
+            return false;
+        }
+
+        auto src    = move.from();
+        auto dst    = move.to();
+        auto moved  = game_board.piece_on( src );
+        bool colour = white_move();
+
+        if ( moved == game::no_piece || game::piece_colour( moved ) != colour ) {
+            return false;
+        }
+
+        // the flag has to be the one the generator gives, pawns only promote to a queen
+        if ( move != to_move( src, dst ) ||
+             ( move.flag() == game::move_flag::promotion && move.promotion() != pieces::name_t::queen ) ) {
+            return false;
+        }
+
+        if ( move.flag() == game::move_flag::castling ) {
+            return src == king_square( colour ) && game::is_set( castling_targets( colour, legality( colour ) ), dst );
+        }
+
+        return game::is_set( game_board.pseudo_targets( src ), dst );
+    }
+
+    bool chess_game::is_legal( move_t const & move ) const
+    {
+        if ( move.flag() == game::move_flag::castling ) {
+            return true;
+        }
+
+        auto src    = move.from();
+        auto dst    = move.to();
+        bool colour = game::piece_colour( game_board.piece_on( src ) );
+
+        auto king = src == king_square( colour ) ? dst : king_square( colour );
+        if ( king == game::num_squares ) {
+            return true;
+        }
+
+        // the board as it is after the move, a captured piece no longer attacks
+        auto occupied = ( game_board.occupancy() ^ game::square_bb( src ) ) | game::square_bb( dst );
+        return !( attackers_to( king, !colour, occupied ) & ~game::square_bb( dst ) );
+    }
+
+    pieces::move_status chess_game::make_move( move_t const & move )
+    {
+        auto src_sq = move.from();
+        auto dst_sq = move.to();
+        auto moved  = game_board.piece_on( src_sq );
+
+        if ( moved == game::no_piece ) {
+            return pieces::move_status::no_piece_to_move;
+        }
+
+        // taken before the move goes on the undo stack, side_to_move reads the last move of a drawn game from it
+        auto state_key = compute_state_key();
+
+        key_history[undo_stack.size() % key_history_size] = hash();
+        undo_stack.push_back( { move, position() } );
+
+        auto captured = game_board.piece_on( dst_sq );
+
+        game_board.play( move );
+        game_attack_map.update( game_board, changed_squares( undo_stack.back() ) );
+
+        auto & pos  = position();
+        bool   pawn = game::piece_type( moved ) == pieces::name_t::pawn;
+
+        bool double_push   = pawn && ( dst_sq - src_sq == 16 || src_sq - dst_sq == 16 );
+        pos.en_passant     = static_cast< std::uint8_t >( double_push ? ( src_sq + dst_sq ) / 2 : game::num_squares );
+        pos.halfmove_clock = pawn || captured != game::no_piece ? 0 : std::min( pos.halfmove_clock + 1, 0xFFFF );
+        if ( !game::piece_colour( moved ) && pos.fullmove_number < 0xFFFF ) {
+            pos.fullmove_number++;
+        }
+
+        update_castling_rights( move );
+
+        // the side that just moved was the side to move, a finished game keeps its state
+        if ( white_move() || black_move() ) {
+            bool colour = !game::piece_colour( moved );
+            bool check  = gives_check( move );
+
+            if ( has_legal_move( colour ) ) {
+                pos.state = colour ? ( check ? game_state::white_check : game_state::white_move )
+                                   : ( check ? game_state::black_check : game_state::black_move );
             }
-            else if ( black_move() ) {
-                if ( game_attack_map.has_attackers( game_board.get( white_king.get().position() ), false ) ) {
-                    state = game_state::white_check;
-                    if ( checkmate( true ) ) {
-                        std::cout << "Black Wins\n";
-                        state = game_state::black_wins;
-                    }
-                }
-                else {
-                    state = game_state::white_move;
-                }
-                black_castling_rights( src_piece_cpy, src.position() );
-                if ( dst == pieces::piece::itopos( 1, 1 ) ) {
-                    queen_side_castle_white = false;
-                }
-                else if ( dst == pieces::piece::itopos( 1, 8 ) ) {
-                    king_side_castle_white = false;
-                }
+            else if ( check ) {
+                pos.state = colour ? game_state::black_wins : game_state::white_wins;
             }
             else {
-                throw std::logic_error( "Impossible Game State" );
+                pos.state = game_state::draw;
             }
         }
-        catch ( const std::exception & e ) {
-            std::cerr << "Error Checking Attack Map\n";
-        }
+
+        // fold the side to move and castling right changes into the key
+        pos.key ^= state_key ^ compute_state_key();
+
         return pieces::move_status::valid;
     }
 
-    void chess_game::white_castling_rights( std::unique_ptr< pieces::piece > const & moved_piece,
-                                            pieces::position_t const &               src_pos )
+    void chess_game::unmake_move()
     {
-        // white castling logic
-        if ( ( king_side_castle_white || queen_side_castle_white ) && moved_piece->colour() ) {
-            if ( moved_piece->type() == pieces::name_t::king ) {
-                king_side_castle_white  = false;
-                queen_side_castle_white = false;
-            }
-            else if ( moved_piece->type() == pieces::name_t::rook ) {
-                if ( queen_side_castle_white &&
-                     src_pos == pieces::position_t( pieces::rank_t::one, pieces::file_t::a ) ) {
-                    queen_side_castle_white = false;
-                }
-                else if ( king_side_castle_white &&
-                          src_pos == pieces::position_t( pieces::rank_t::one, pieces::file_t::h ) ) {
-                    king_side_castle_white = false;
-                }
-            }
+        if ( undo_stack.empty() ) {
+            return;
         }
+
+        auto const & undo = undo_stack.back();
+
+        game_board.undo( undo.before );
+        game_attack_map.update( game_board, changed_squares( undo ) );
+
+        undo_stack.pop_back();
     }
 
-    void chess_game::black_castling_rights( std::unique_ptr< pieces::piece > const & moved_piece,
-                                            pieces::position_t const &               src_pos )
+    bool chess_game::is_repetition() const
     {
-        // black castling logic
-        if ( ( king_side_castle_black || queen_side_castle_black ) && !moved_piece->colour() ) {
-            if ( moved_piece->type() == pieces::name_t::king ) {
-                king_side_castle_black  = false;
-                queen_side_castle_black = false;
+        auto window =
+            std::min< std::size_t >( { position().halfmove_clock, undo_stack.size(), key_history_size - 1 } );
+
+        // the same side was to move every second ply, and it takes at least four to come back
+        for ( std::size_t back = 4; back <= window; back += 2 ) {
+            if ( key_history[( undo_stack.size() - back ) % key_history_size] == hash() ) {
+                return true;
             }
-            else if ( moved_piece->type() == pieces::name_t::rook ) {
-                if ( queen_side_castle_black &&
-                     src_pos == pieces::position_t( pieces::rank_t::eight, pieces::file_t::a ) ) {
-                    queen_side_castle_black = false;
-                }
-                else if ( king_side_castle_black &&
-                          src_pos == pieces::position_t( pieces::rank_t::eight, pieces::file_t::h ) ) {
-                    king_side_castle_black = false;
-                }
+        }
+        return false;
+    }
+
+    void chess_game::restore( game::position_state const & snapshot )
+    {
+        position() = snapshot;
+        update_attack_map();
+    }
+
+    void chess_game::set_turn( bool const colour )
+    {
+        auto state_key   = compute_state_key();
+        position().state = colour ? game_state::white_move : game_state::black_move;
+        position().key ^= state_key ^ compute_state_key();
+    }
+
+    game::bitboard_t chess_game::changed_squares( undo_t const & undo )
+    {
+        auto src = undo.move.from();
+        auto dst = undo.move.to();
+
+        auto changed = game::square_bb( src ) | game::square_bb( dst );
+
+        auto moved = undo.before.mailbox[src];
+        bool king  = moved == game::white_king || moved == game::black_king;
+        if ( king && ( dst - src == 2 || src - dst == 2 ) ) {
+            int rank = game::rank_of( src );
+            changed |= dst > src ? game::square_bb( game::make_square( rank, 6 ) ) |
+                                       game::square_bb( game::make_square( rank, 8 ) )
+                                 : game::square_bb( game::make_square( rank, 1 ) ) |
+                                       game::square_bb( game::make_square( rank, 4 ) );
+        }
+
+        return changed;
+    }
+
+    game::zobrist_key_t chess_game::compute_state_key() const
+    {
+        game::zobrist_key_t key = 0;
+
+        // a finished game keeps the side bit of the side that would be to move, as a position loaded from its FEN has
+        if ( side_to_move() ) {
+            key ^= game::zobrist.white_to_move;
+        }
+
+        for ( int right = 0; right < 4; right++ ) {
+            if ( position().castling & ( 1 << right ) ) {
+                key ^= game::zobrist.castling_availability[right];
             }
         }
+
+        return key;
+    }
+
+    void chess_game::update_castling_rights( move_t const & move )
+    {
+        position().castling &= ~( castling_masks[move.from()] | castling_masks[move.to()] );
     }
 
     bool chess_game::can_castle( bool const color ) const
     {
         if ( color ) {
-            return ( king_side_castle_white || queen_side_castle_white );
+            return position().castling & ( game::white_king_side | game::white_queen_side );
         }
         else {
-            return ( king_side_castle_black || queen_side_castle_black );
+            return position().castling & ( game::black_king_side | game::black_queen_side );
         }
     }
 
@@ -314,13 +529,34 @@ namespace chess {
     }
     void chess_game::remove_piece_at( pieces::position_t position ) { game_board.remove_piece_at( position ); }
 
-    std::vector< std::string > chess_game::get_move_history() const { return game_board.get_move_history(); }
+    std::vector< std::string > const & chess_game::get_move_history() const { return game_board.get_move_history(); }
 
-    bool chess_game::white_move() const { return state == game_state::white_move || state == game_state::white_check; }
+    bool chess_game::white_move() const
+    {
+        return position().state == game_state::white_move || position().state == game_state::white_check;
+    }
 
-    bool chess_game::black_move() const { return state == game_state::black_move || state == game_state::black_check; }
+    bool chess_game::black_move() const
+    {
+        return position().state == game_state::black_move || position().state == game_state::black_check;
+    }
+
+    bool chess_game::side_to_move() const
+    {
+        switch ( position().state ) {
+        case game_state::black_wins:
+            return true;
+        case game_state::white_wins:
+            return false;
+        case game_state::draw:
+            // stalemate, the side that did not make the last move
+            return undo_stack.empty() || !game::piece_colour( game_board.piece_on( undo_stack.back().move.to() ) );
+        default:
+            return !black_move();
+        }
+    }
 
-    game::space const & chess_game::get( pieces::position_t const & pos ) const { return game_board.get( pos ); }
+    game::space chess_game::get( pieces::position_t const & pos ) const { return game_board.get( pos ); }
 
     void chess_game::load_from_string( const std::string & game_string )
     {
@@ -329,27 +565,217 @@ namespace chess {
         // Extract board portion (everything before metadata section)
         std::string board_portion = extract_board_portion( game_string );
 
-        // Load the board using the board class function
+        // Load the board using the board class function, this also resets the clocks
         game_board.load_from_string( board_portion );
 
         // Parse metadata section
         parse_metadata_section( game_string );
+        drop_unusable_castling_rights();
+        undo_stack.clear();
+        position().key ^= compute_state_key();
 
         update_attack_map();
+    }
 
-        for ( int i = 1; i <= 8; i++ ) {
-            for ( int j = 1; j <= 8; j++ ) {
-                auto & sp = game_board.get( pieces::piece::itopos( i, j ).value() );
-                if ( sp.piece && sp.piece->type() == pieces::name_t::king ) {
-                    if ( sp.piece->colour() ) {
-                        white_king = *reinterpret_cast< pieces::king * >( sp.piece.get() );
-                    }
-                    else {
-                        black_king = *reinterpret_cast< pieces::king * >( sp.piece.get() );
-                    }
+    void chess_game::load_from_fen( std::string_view const fen )
+    {
+        std::string_view rest = fen;
+
+        auto placement = next_field( rest );
+        auto side      = next_field( rest );
+        auto castling  = next_field( rest );
+        auto passant   = next_field( rest );
+        auto halfmove  = next_field( rest );
+        auto fullmove  = next_field( rest );
+
+        if ( !next_field( rest ).empty() ) {
+            throw std::invalid_argument( "Invalid FEN: " + std::string( fen ) );
+        }
+
+        load_fen_fields( placement, side, castling, passant, halfmove, fullmove );
+    }
+
+    std::string_view chess_game::load_from_epd( std::string_view const epd )
+    {
+        std::string_view rest = epd;
+
+        auto placement = next_field( rest );
+        auto side      = next_field( rest );
+        auto castling  = next_field( rest );
+        auto passant   = next_field( rest );
+
+        // the clocks are operations in EPD (hmvc and fmvn), they are left to the caller
+        load_fen_fields( placement, side, castling, passant, {}, {} );
+
+        auto start = rest.find_first_not_of( whitespace );
+        auto end   = rest.find_last_not_of( whitespace );
+        return start == std::string_view::npos ? std::string_view{} : rest.substr( start, end - start + 1 );
+    }
+
+    void chess_game::load_fen_fields( std::string_view const placement, std::string_view const side,
+                                      std::string_view const castling, std::string_view const en_passant_square,
+                                      std::string_view const halfmove, std::string_view const fullmove )
+    {
+        if ( side != "w" && side != "b" ) {
+            throw std::invalid_argument( "Invalid FEN side to move: " + std::string( side ) );
+        }
+
+        bool castle[4] = {};  // K, Q, k, q
+        if ( castling != "-" ) {
+            if ( castling.empty() ) {
+                throw std::invalid_argument( "Invalid FEN: missing castling rights" );
+            }
+
+            for ( char right : castling ) {
+                auto index = std::string_view( "KQkq" ).find( right );
+                if ( index == std::string_view::npos ) {
+                    throw std::invalid_argument( "Invalid FEN castling rights: " + std::string( castling ) );
                 }
+                castle[index] = true;
+            }
+        }
+
+        game::square_t passant = game::num_squares;
+        if ( !en_passant_square.empty() && en_passant_square != "-" ) {
+            if ( en_passant_square.size() != 2 || en_passant_square[0] < 'a' || en_passant_square[0] > 'h' ||
+                 ( en_passant_square[1] != '3' && en_passant_square[1] != '6' ) ) {
+                throw std::invalid_argument( "Invalid FEN en passant square: " + std::string( en_passant_square ) );
+            }
+            passant = game::make_square( en_passant_square[1] - '0', en_passant_square[0] - 'a' + 1 );
+        }
+
+        int halfmove_value = 0;
+        int fullmove_value = 1;
+        if ( !parse_clock( halfmove, halfmove_value ) || !parse_clock( fullmove, fullmove_value ) ) {
+            throw std::invalid_argument( "Invalid FEN move clocks: " + std::string( halfmove ) + " " +
+                                         std::string( fullmove ) );
+        }
+
+        game_board.load_from_fen( placement );
+
+        auto & pos = position();
+        pos.castling =
+            castle[0] * game::white_king_side | castle[1] * game::white_queen_side |
+            castle[2] * game::black_king_side | castle[3] * game::black_queen_side;
+        pos.en_passant      = static_cast< std::uint8_t >( passant );
+        pos.halfmove_clock  = static_cast< std::uint16_t >( std::min( halfmove_value, 0xFFFF ) );
+        pos.fullmove_number = static_cast< std::uint16_t >( std::clamp( fullmove_value, 1, 0xFFFF ) );
+
+        finish_load( side == "w" );
+    }
+
+    void chess_game::drop_unusable_castling_rights()
+    {
+        for ( auto const [sq, piece] : castling_homes ) {
+            if ( game_board.piece_on( sq ) != piece ) {
+                position().castling &= ~castling_masks[sq];
+            }
+        }
+    }
+
+    void chess_game::finish_load( bool const white )
+    {
+        drop_unusable_castling_rights();
+
+        auto king = king_square( white );
+        if ( king != game::num_squares && attackers_to( king, !white ) ) {
+            position().state = white ? game_state::white_check : game_state::black_check;
+        }
+        else {
+            position().state = white ? game_state::white_move : game_state::black_move;
+        }
+
+        undo_stack.clear();
+        position().key ^= compute_state_key();
+
+        update_attack_map();
+    }
+
+    std::size_t chess_game::write_fen( char * out ) const
+    {
+        char * start = out;
+
+        out += game_board.write_fen( out );
+
+        auto const & pos = position();
+        *out++           = ' ';
+        *out++           = side_to_move() ? 'w' : 'b';
+        *out++           = ' ';
+
+        char * rights = out;
+        for ( int right = 0; right < 4; right++ ) {
+            if ( pos.castling & ( 1 << right ) ) {
+                *out++ = "KQkq"[right];
             }
         }
+        if ( out == rights ) {
+            *out++ = '-';
+        }
+
+        *out++ = ' ';
+        if ( pos.en_passant == game::num_squares ) {
+            *out++ = '-';
+        }
+        else {
+            *out++ = static_cast< char >( 'a' + game::file_of( pos.en_passant ) - 1 );
+            *out++ = static_cast< char >( '0' + game::rank_of( pos.en_passant ) );
+        }
+
+        *out++ = ' ';
+        out    = std::to_chars( out, start + max_fen_length, pos.halfmove_clock ).ptr;
+        *out++ = ' ';
+        out    = std::to_chars( out, start + max_fen_length, pos.fullmove_number ).ptr;
+
+        return out - start;
+    }
+
+    std::string chess_game::to_fen() const
+    {
+        char buffer[max_fen_length];
+        return std::string( buffer, write_fen( buffer ) );
+    }
+
+    void chess_game::load_from_packed( game::packed_position const & packed )
+    {
+        if ( packed.en_passant != game::num_squares &&
+             ( packed.en_passant > game::num_squares ||
+               ( game::rank_of( packed.en_passant ) != 3 && game::rank_of( packed.en_passant ) != 6 ) ) ) {
+            throw std::invalid_argument( "Invalid packed position: bad en passant square" );
+        }
+
+        if ( packed.flags & 0xE0 ) {
+            throw std::invalid_argument( "Invalid packed position: reserved flag bits set" );
+        }
+
+        game_board.load_from_packed( packed );
+
+        // rights without their king and rook are dropped by finish_load as for a FEN
+        auto & pos          = position();
+        pos.castling        = ( packed.flags >> 1 ) & 0x0F;
+        pos.en_passant      = packed.en_passant;
+        pos.halfmove_clock  = static_cast< std::uint16_t >( packed.halfmove_clock[0] | packed.halfmove_clock[1] << 8 );
+        pos.fullmove_number = static_cast< std::uint16_t >(
+            std::max( packed.fullmove_number[0] | packed.fullmove_number[1] << 8, 1 ) );
+
+        finish_load( packed.flags & 0x01 );
+    }
+
+    game::packed_position chess_game::to_packed() const
+    {
+        game::packed_position packed{};
+
+        game_board.write_packed( packed );
+
+        auto const & pos  = position();
+        packed.flags      = side_to_move() | pos.castling << 1;
+        packed.en_passant = pos.en_passant;
+
+        packed.halfmove_clock[0]  = static_cast< std::uint8_t >( pos.halfmove_clock );
+        packed.halfmove_clock[1]  = static_cast< std::uint8_t >( pos.halfmove_clock >> 8 );
+        packed.fullmove_number[0] = static_cast< std::uint8_t >( pos.fullmove_number );
+        packed.fullmove_number[1] = static_cast< std::uint8_t >( pos.fullmove_number >> 8 );
+
+        return packed;
     }
 
     // Extract the board portion from the game string
@@ -393,16 +819,16 @@ namespace chess {
             parse_game_state( line );
         }
         else if ( line.find( "  White King-side:" ) == 0 ) {
-            king_side_castle_white = parse_castle_right( line );
+            set_castling_right( game::white_king_side, parse_castle_right( line ) );
         }
         else if ( line.find( "  White Queen-side:" ) == 0 ) {
-            queen_side_castle_white = parse_castle_right( line );
+            set_castling_right( game::white_queen_side, parse_castle_right( line ) );
         }
         else if ( line.find( "  Black King-side:" ) == 0 ) {
-            king_side_castle_black = parse_castle_right( line );
+            set_castling_right( game::black_king_side, parse_castle_right( line ) );
         }
         else if ( line.find( "  Black Queen-side:" ) == 0 ) {
-            queen_side_castle_black = parse_castle_right( line );
+            set_castling_right( game::black_queen_side, parse_castle_right( line ) );
         }
         // Skip "Castling Rights:" header line
     }
@@ -422,7 +848,7 @@ namespace chess {
 
         // Assuming game_state has a from_string method or constructor
         // If not, you'll need to implement the conversion based on your enum
-        state = parse_game_state_enum( state_str );
+        position().state = parse_game_state_enum( state_str );
     }
 
     // Parse castle right from line
@@ -431,6 +857,16 @@ namespace chess {
         return line.find( "Available" ) != std::string::npos;
     }
 
+    void chess_game::set_castling_right( game::castling_right const right, bool const available )
+    {
+        if ( available ) {
+            position().castling |= right;
+        }
+        else {
+            position().castling &= ~right;
+        }
+    }
+
     // Convert string to game_state enum
     game_state chess_game::parse_game_state_enum( const std::string & state_str )
     {
@@ -473,67 +909,33 @@ namespace chess {
         output << "\n--- Game Metadata ---\n";
 
         // Game state
-        output << "State: " << chess::to_string( state ) << "\n";
+        output << "State: " << chess::to_string( get_state() ) << "\n";
 
         // Castling rights
+        auto available = [this]( game::castling_right const right ) {
+            return position().castling & right ? "Available" : "Lost";
+        };
         output << "Castling Rights:\n";
-        output << "  White King-side:  " << ( king_side_castle_white ? "Available" : "Lost" ) << "\n";
-        output << "  White Queen-side: " << ( queen_side_castle_white ? "Available" : "Lost" ) << "\n";
-        output << "  Black King-side:  " << ( king_side_castle_black ? "Available" : "Lost" ) << "\n";
-        output << "  Black Queen-side: " << ( queen_side_castle_black ? "Available" : "Lost" ) << "\n";
-        output << " White King Pos: " << pieces::to_string( white_king.get().position() ) << "\n";
-        output << " Black King Pos: " << pieces::to_string( black_king.get().position() ) << "\n";
+        output << "  White King-side:  " << available( game::white_king_side ) << "\n";
+        output << "  White Queen-side: " << available( game::white_queen_side ) << "\n";
+        output << "  Black King-side:  " << available( game::black_king_side ) << "\n";
+        output << "  Black Queen-side: " << available( game::black_queen_side ) << "\n";
+
+        for ( bool colour : { true, false } ) {
+            auto king = king_square( colour );
+            output << ( colour ? " White" : " Black" ) << " King Pos: "
+                   << ( king == game::num_squares ? "none" : pieces::to_string( game::to_position( king ) ) ) << "\n";
+        }
 
         return output.str();
     }
 
-    void chess_game::update_attack_map()
-    {
-        game_attack_map.clear();
-
-        for ( int i = 1; i <= 8; i++ ) {
-            for ( int j = 1; j <= 8; j++ ) {
-                auto & space = game_board.get( pieces::piece::itopos( i, j ).value() );
-                if ( !space.piece ) {
-                    continue;
-                }
-                auto attacks = possible_attacks( space );
-
-                for ( auto m : attacks ) {
-                    game_attack_map.add_attacker( space, m );
-                }
-            }
-        }
-    }
+    void chess_game::update_attack_map() { game_attack_map.rebuild( game_board ); }
 
     chess_game::attack_map const chess_game::generate_attack_map( game::board board ) const
     {
-        std::chrono::high_resolution_clock::time_point start, end, startl, endl;
-        std::chrono::microseconds                      duration;
-
-        start = std::chrono::high_resolution_clock::now();
-
         attack_map generated_map;
-        generated_map.clear();
-
-        for ( int i = 1; i <= 8; i++ ) {
-            for ( int j = 1; j <= 8; j++ ) {
-                auto & space = board.get( pieces::piece::itopos( i, j ).value() );
-
-                if ( !space.piece ) {
-                    continue;
-                }
-
-                auto attacks = possible_attacks( board, space );
-
-                for ( auto m : attacks ) {
-                    generated_map.add_attacker( space, m );
-                }
-            }
-        }
-
-        end      = std::chrono::high_resolution_clock::now();
-        duration = std::chrono::duration_cast< std::chrono::microseconds >( end - start );
+        generated_map.rebuild( board );
 
         return generated_map;
     }
@@ -562,31 +964,41 @@ namespace chess {
         return game_board.possible_moves( src );
     }
 
-    std::vector< move_t > chess_game::legal_moves() const
+    game::move_list chess_game::legal_moves() const
     {
-        auto                  board_copy = game_board;
-        std::vector< move_t > moves;
-        moves.reserve( 3000 );
+        game::move_list moves;
+        generate< game::gen_type::legal >( moves );
+        return moves;
+    }
 
-        for ( int i = 1; i <= 8; i++ ) {
-            for ( int j = 1; j <= 8; j++ ) {
-                auto & src = board_copy.get( pieces::piece::itopos( i, j ).value() );
+    pieces::move_status chess_game::possible_moves( game::space const & src, game::move_list & moves ) const
+    {
+        auto turn_status = validate_turn( src );
+        if ( turn_status != pieces::move_status::valid ) {
+            return turn_status;
+        }
 
-                std::vector< game::space > dsts;
-                dsts.reserve( 100 );
-                possible_moves( board_copy, src, dsts );
+        moves.clear();
+        add_legal_moves( game::to_square( src.position() ), legality( src.piece->colour() ), moves );
 
-                for ( auto const & dst : dsts ) {
-                    moves.push_back( { src, dst } );
-                }
-            }
-        }
-        return moves;
+        return pieces::move_status::valid;
     }
+
     pieces::move_status chess_game::possible_moves( game::space const & src, std::vector< game::space > & moves ) const
     {
-        auto board_copy = game_board;
-        return possible_moves( board_copy, src, moves );
+        game::move_list list;
+
+        auto status = possible_moves( src, list );
+        if ( status != pieces::move_status::valid ) {
+            return status;
+        }
+
+        moves.clear();
+        for ( auto const & move : list ) {
+            moves.push_back( game_board.get( move.to() ) );
+        }
+
+        return pieces::move_status::valid;
     }
 
     // Helper function to validate turn order
@@ -607,246 +1019,327 @@ namespace chess {
         return pieces::move_status::valid;
     }
 
-    // Helper function to check if castling squares are safe and empty
-    bool chess_game::are_castle_squares_safe( game::board &                      board_copy,
-                                              const std::vector< game::space > & castle_squares,
-                                              bool                               piece_colour ) const
+    chess_game::legality_t chess_game::legality( bool const colour ) const
     {
-        for ( const auto & square : castle_squares ) {
-            if ( square.piece ) {
-                return false;  // Square is occupied
-            }
-            if ( game_attack_map.has_attackers( square, !piece_colour ) ) {
-                return false;  // Square is under attack
+        legality_t info{
+            .king     = game::num_squares,
+            .checkers = game::empty_bb,
+            .pinned   = game::empty_bb,
+            .evasions = ~game::empty_bb,
+        };
+
+        info.king = king_square( colour );
+        if ( info.king == game::num_squares ) {
+            return info;
+        }
+
+        auto occupied = game_board.occupancy();
+        info.checkers = attackers_to( info.king, !colour, occupied );
+
+        // enemy sliders that would see the king on an empty board, a lone own piece in between is pinned
+        auto queens  = game_board.piece_set( pieces::name_t::queen, !colour );
+        auto snipers = ( game::rook_attacks( info.king, game::empty_bb ) &
+                         ( game_board.piece_set( pieces::name_t::rook, !colour ) | queens ) ) |
+                       ( game::bishop_attacks( info.king, game::empty_bb ) &
+                         ( game_board.piece_set( pieces::name_t::bishop, !colour ) | queens ) );
+
+        while ( snipers ) {
+            auto blockers = game::between_bb[info.king][game::pop_lsb( snipers )] & occupied;
+            if ( game::popcount( blockers ) == 1 ) {
+                info.pinned |= blockers & game_board.colour_set( colour );
             }
         }
-        return true;
-    }
 
-    // Helper function to get castling squares for white kingside
-    std::vector< game::space > chess_game::get_white_kingside_squares( game::board & board_copy ) const
-    {
-        std::vector< game::space > castle_squares;
-        castle_squares.push_back( board_copy.get( pieces::piece::itopos( 1, 6 ).value() ) );
-        castle_squares.push_back( board_copy.get( pieces::piece::itopos( 1, 7 ).value() ) );
-        return castle_squares;
-    }
+        // in check a move has to capture the checker or block it, in double check only the king can move
+        if ( info.checkers ) {
+            info.evasions = game::popcount( info.checkers ) > 1
+                                ? game::empty_bb
+                                : info.checkers | game::between_bb[info.king][game::lsb( info.checkers )];
+        }
 
-    // Helper function to get castling squares for white queenside
-    std::vector< game::space > chess_game::get_white_queenside_squares( game::board & board_copy ) const
-    {
-        std::vector< game::space > castle_squares;
-        castle_squares.push_back( board_copy.get( pieces::piece::itopos( 1, 2 ).value() ) );
-        castle_squares.push_back( board_copy.get( pieces::piece::itopos( 1, 3 ).value() ) );
-        castle_squares.push_back( board_copy.get( pieces::piece::itopos( 1, 4 ).value() ) );
-        return castle_squares;
+        return info;
     }
 
-    // Helper function to get castling squares for black kingside
-    std::vector< game::space > chess_game::get_black_kingside_squares( game::board & board_copy ) const
+    game::bitboard_t chess_game::legal_targets( game::square_t const sq, legality_t const & info ) const
     {
-        std::vector< game::space > castle_squares;
-        castle_squares.push_back( board_copy.get( pieces::piece::itopos( 8, 6 ).value() ) );
-        castle_squares.push_back( board_copy.get( pieces::piece::itopos( 8, 7 ).value() ) );
-        return castle_squares;
-    }
+        auto targets = game_board.pseudo_targets( sq );
 
-    // Helper function to get castling squares for black queenside
-    std::vector< game::space > chess_game::get_black_queenside_squares( game::board & board_copy ) const
-    {
-        std::vector< game::space > castle_squares;
-        castle_squares.push_back( board_copy.get( pieces::piece::itopos( 8, 2 ).value() ) );
-        castle_squares.push_back( board_copy.get( pieces::piece::itopos( 8, 3 ).value() ) );
-        castle_squares.push_back( board_copy.get( pieces::piece::itopos( 8, 4 ).value() ) );
-        return castle_squares;
-    }
+        if ( sq == info.king ) {
+            bool colour = game::piece_colour( game_board.piece_on( sq ) );
 
-    // Helper function to add white castling moves
-    void chess_game::add_white_castling_moves( game::board & board_copy, const game::space & src,
-                                               std::vector< game::space > & possible_moves ) const
-    {
-        bool king_in_check = game_attack_map.has_attackers( src, !src.piece->colour() );
+            // the king must not block the attack on the square it steps back to
+            auto             blockers = game_board.occupancy() ^ game::square_bb( sq );
+            game::bitboard_t safe     = game::empty_bb;
 
-        // Kingside castling
-        if ( !king_in_check && king_side_castle_white ) {
-            auto castle_squares = get_white_kingside_squares( board_copy );
-            if ( are_castle_squares_safe( board_copy, castle_squares, src.piece->colour() ) ) {
-                possible_moves.push_back( board_copy.get( { pieces::rank_t::one, pieces::file_t::g } ) );
+            while ( targets ) {
+                auto dst = game::pop_lsb( targets );
+                if ( !attackers_to( dst, !colour, blockers ) ) {
+                    safe |= game::square_bb( dst );
+                }
             }
+            return safe;
         }
 
-        // Queenside castling
-        if ( !king_in_check && queen_side_castle_white ) {
-            auto castle_squares = get_white_queenside_squares( board_copy );
-            if ( are_castle_squares_safe( board_copy, castle_squares, src.piece->colour() ) ) {
-                possible_moves.push_back( board_copy.get( { pieces::rank_t::one, pieces::file_t::c } ) );
-            }
+        targets &= info.evasions;
+
+        if ( game::is_set( info.pinned, sq ) ) {
+            targets &= game::line_bb[info.king][sq];
         }
+
+        return targets;
     }
 
-    // Helper function to add black castling moves
-    void chess_game::add_black_castling_moves( game::board & board_copy, const game::space & src,
-                                               std::vector< game::space > & possible_moves ) const
+    game::bitboard_t chess_game::castling_targets( bool const colour, legality_t const & info ) const
     {
-        bool king_in_check = game_attack_map.has_attackers( src, !src.piece->colour() );
+        if ( info.king == game::num_squares || info.checkers ) {
+            return game::empty_bb;
+        }
 
-        // Kingside castling
-        if ( !king_in_check && king_side_castle_black ) {
-            auto castle_squares = get_black_kingside_squares( board_copy );
-            if ( are_castle_squares_safe( board_copy, castle_squares, src.piece->colour() ) ) {
-                possible_moves.push_back( board_copy.get( { pieces::rank_t::eight, pieces::file_t::g } ) );
-            }
+        int rank = colour ? 1 : 8;
+        if ( info.king != game::make_square( rank, 5 ) ) {
+            return game::empty_bb;
         }
 
-        // Queenside castling
-        if ( !king_in_check && queen_side_castle_black ) {
-            auto castle_squares = get_black_queenside_squares( board_copy );
-            if ( are_castle_squares_safe( board_copy, castle_squares, src.piece->colour() ) ) {
-                possible_moves.push_back( board_copy.get( { pieces::rank_t::eight, pieces::file_t::c } ) );
+        // the loaders drop rights without their rook, a right is still never trusted to have one
+        auto rook       = game::make_piece_index( pieces::name_t::rook, colour );
+        bool king_side  = ( position().castling & ( colour ? game::white_king_side : game::black_king_side ) ) &&
+                          game_board.piece_on( game::make_square( rank, 8 ) ) == rook;
+        bool queen_side = ( position().castling & ( colour ? game::white_queen_side : game::black_queen_side ) ) &&
+                          game_board.piece_on( game::make_square( rank, 1 ) ) == rook;
+
+        // every square between the king and rook has to be empty and not attacked
+        auto path_is_safe = [this, colour]( game::bitboard_t path ) {
+            if ( path & game_board.occupancy() ) {
+                return false;
             }
+
+            while ( path ) {
+                if ( attackers_to( game::pop_lsb( path ), !colour ) ) {
+                    return false;
+                }
+            }
+            return true;
+        };
+
+        game::bitboard_t targets = game::empty_bb;
+
+        if ( king_side && path_is_safe( game::square_bb( game::make_square( rank, 6 ) ) |
+                                        game::square_bb( game::make_square( rank, 7 ) ) ) ) {
+            targets |= game::square_bb( game::make_square( rank, 7 ) );
+        }
+
+        if ( queen_side && path_is_safe( game::square_bb( game::make_square( rank, 2 ) ) |
+                                         game::square_bb( game::make_square( rank, 3 ) ) |
+                                         game::square_bb( game::make_square( rank, 4 ) ) ) ) {
+            targets |= game::square_bb( game::make_square( rank, 3 ) );
         }
+
+        return targets;
     }
 
-    // Helper function to add castling moves for kings
-    void chess_game::add_castling_moves( game::board & board_copy, const game::space & src,
-                                         std::vector< game::space > & possible_moves ) const
+    void chess_game::add_legal_moves( game::square_t const sq, legality_t const & info,
+                                      game::move_list & moves ) const
     {
-        if ( src.piece->type() != pieces::name_t::king ) {
-            return;
+        // pawns always promote to a queen
+        bool promotes = game::piece_type( game_board.piece_on( sq ) ) == pieces::name_t::pawn;
+
+        for ( auto targets = legal_targets( sq, info ); targets; ) {
+            auto dst = game::pop_lsb( targets );
+            if ( promotes && ( game::rank_of( dst ) == 1 || game::rank_of( dst ) == 8 ) ) {
+                moves.push_back( { sq, dst, game::move_flag::promotion, pieces::name_t::queen } );
+            }
+            else {
+                moves.push_back( { sq, dst } );
+            }
         }
 
-        if ( src.piece->colour() ) {
-            add_white_castling_moves( board_copy, src, possible_moves );
+        if ( sq != info.king ) {
+            return;
         }
-        else {
-            add_black_castling_moves( board_copy, src, possible_moves );
+
+        // king side first
+        bool colour  = game::piece_colour( game_board.piece_on( sq ) );
+        auto castles = castling_targets( colour, info );
+        for ( int file : { 7, 3 } ) {
+            auto dst = game::make_square( colour ? 1 : 8, file );
+            if ( game::is_set( castles, dst ) ) {
+                moves.push_back( { sq, dst, game::move_flag::castling } );
+            }
         }
     }
 
-    bool chess_game::is_king_move_safe( game::board & board_copy, const game::space & src,
-                                        const game::space & dst ) const
+    game::bitboard_t chess_game::attackers_to( game::square_t const sq, bool const colour ) const
+    {
+        return game_board.attackers_to( sq, colour, game_board.occupancy() );
+    }
+
+    game::bitboard_t chess_game::attackers_to( game::square_t const sq, bool const colour,
+                                               game::bitboard_t const blockers ) const
     {
-        // Copy the king piece
-        std::unique_ptr< pieces::piece > king_piece =
-            pieces::piece::copy_piece( *board_copy.get( src.position() ).piece );
+        return game_board.attackers_to( sq, colour, blockers );
+    }
 
-        // Save any piece at destination for reversion
-        std::unique_ptr< pieces::piece > captured_piece = nullptr;
-        if ( board_copy.get( dst.position() ).piece ) {
-            captured_piece = pieces::piece::copy_piece( *board_copy.get( dst.position() ).piece );
-            board_copy.remove_piece_at( dst.position() );
+    game::bitboard_t chess_game::xray_attackers_to( game::square_t const sq, bool const colour ) const
+    {
+        auto blockers  = game_board.occupancy();
+        auto attackers = attackers_to( sq, colour, blockers );
+
+        // lift the attackers found so far off the board until no new slider shows up behind them
+        for ( auto found = attackers; found; ) {
+            blockers ^= found;
+            found = attackers_to( sq, colour, blockers ) & ~attackers;
+            attackers |= found;
         }
 
-        // Simulate move
-        board_copy.remove_piece_at( src.position() );
-        board_copy.add_piece_at( *king_piece, dst.position() );
-
-        // Generate attack map and check if king is safe
-        auto temp_attack_map = generate_attack_map( board_copy );
-        bool king_safe       = !temp_attack_map.has_attackers( dst, !king_piece->colour() );
+        return attackers;
+    }
 
-        // Revert move
-        board_copy.remove_piece_at( dst.position() );
-        board_copy.add_piece_at( *king_piece, src.position() );
-        if ( captured_piece )
-            board_copy.add_piece_at( *captured_piece, dst.position() );
 
-        return king_safe;
+    game::square_t chess_game::least_valuable( game::bitboard_t const attackers, bool const colour ) const
+    {
+        for ( auto type : { pieces::name_t::pawn, pieces::name_t::knight, pieces::name_t::bishop, pieces::name_t::rook,
+                            pieces::name_t::queen, pieces::name_t::king } ) {
+            if ( auto set = attackers & game_board.piece_set( type, colour ) ) {
+                return game::lsb( set );
+            }
+        }
+        return game::num_squares;
     }
 
-    bool chess_game::is_non_king_move_safe( game::board & board_copy, const game::space & src,
-                                            const game::space & dst ) const
+    int chess_game::see( move_t const & move ) const
     {
-        // Copy the moving piece
-        std::unique_ptr< pieces::piece > moving_piece =
-            pieces::piece::copy_piece( *board_copy.get( src.position() ).piece );
+        if ( move.flag() == game::move_flag::castling ) {
+            return 0;
+        }
 
-        // Save any piece at destination for later reversion
-        std::unique_ptr< pieces::piece > captured_piece = nullptr;
-        if ( board_copy.get( dst.position() ).piece ) {
-            captured_piece = pieces::piece::copy_piece( *board_copy.get( dst.position() ).piece );
-            board_copy.remove_piece_at( dst.position() );
+        auto from  = move.from();
+        auto to    = move.to();
+        auto moved = game_board.piece_on( from );
+        if ( moved == game::no_piece ) {
+            return 0;
         }
 
-        // Perform simulated move
-        board_copy.remove_piece_at( src.position() );
-        board_copy.add_piece_at( *moving_piece, dst.position() );
+        auto diagonal = diagonal_sliders( game_board );
+        auto straight = straight_sliders( game_board );
+
+        // gain[d] is what the side making capture d wins if the exchange stops after it
+        int  gain[32];
+        int  depth    = 0;
+        auto captured = game_board.piece_on( to );
+        int  on_board = see_value( game::piece_type( moved ) );
 
-        // Get king's current position
-        const game::space & king_space = moving_piece->colour() ? board_copy.get( white_king.get().position() )
-                                                                : board_copy.get( black_king.get().position() );
+        gain[0] = captured == game::no_piece ? 0 : see_value( game::piece_type( captured ) );
+        if ( move.flag() == game::move_flag::promotion ) {
+            gain[0] += see_value( pieces::name_t::queen ) - see_value( pieces::name_t::pawn );
+            on_board = see_value( pieces::name_t::queen );
+        }
 
-        // Generate attack map and check king safety
-        auto temp_attack_map = generate_attack_map( board_copy );
-        bool king_safe       = !temp_attack_map.has_attackers( king_space, !moving_piece->colour() );
+        auto occupied  = game_board.occupancy() ^ game::square_bb( from );
+        auto attackers = ( attackers_to( to, true, occupied ) | attackers_to( to, false, occupied ) ) & occupied;
+        bool colour    = !game::piece_colour( moved );
 
-        // Revert move
-        board_copy.remove_piece_at( dst.position() );
-        board_copy.add_piece_at( *moving_piece, src.position() );
-        if ( captured_piece )
-            board_copy.add_piece_at( *captured_piece, dst.position() );
+        while ( depth + 1 < 32 ) {
+            auto sq = least_valuable( attackers, colour );
+            if ( sq == game::num_squares ) {
+                break;
+            }
 
-        return king_safe;
-    }
+            // the king can only take if nothing takes it back, as in see_ge
+            if ( game::piece_type( game_board.piece_on( sq ) ) == pieces::name_t::king &&
+                 ( attackers & game_board.colour_set( !colour ) ) ) {
+                break;
+            }
 
-    // Helper function to validate individual moves
-    bool chess_game::is_move_legal( game::board & board_copy, const game::space & src, const game::space & dst ) const
-    {
-        if ( src.piece->type() == pieces::name_t::king ) {
-            return is_king_move_safe( board_copy, src, dst );
+            depth++;
+            gain[depth] = on_board - gain[depth - 1];
+            on_board    = see_value( game::piece_type( game_board.piece_on( sq ) ) );
+
+            // sliders behind the piece that just captured join in
+            occupied ^= game::square_bb( sq );
+            attackers |= ( game::bishop_attacks( to, occupied ) & diagonal ) |
+                         ( game::rook_attacks( to, occupied ) & straight );
+            attackers &= occupied;
+            colour = !colour;
         }
-        else {
-            return is_non_king_move_safe( board_copy, src, dst );
+
+        // each side only recaptures if it does not lose by it
+        while ( depth > 0 ) {
+            gain[depth - 1] = -std::max( -gain[depth - 1], gain[depth] );
+            depth--;
         }
-    }
 
-    // Helper function to filter illegal moves
-    void chess_game::filter_illegal_moves( game::board & board_copy, const game::space & src,
-                                           std::vector< game::space > & possible_moves ) const
-    {
-        std::erase_if( possible_moves, [this, &src, &board_copy]( const game::space & dst ) {
-            return !is_move_legal( board_copy, src, dst );
-        } );
+        return gain[0];
     }
 
-    // Main function - now much cleaner and more focused
-    pieces::move_status chess_game::possible_moves( game::board & board_copy, const game::space & src,
-                                                    std::vector< game::space > & possible_moves ) const
+    bool chess_game::see_ge( move_t const & move, int const threshold ) const
     {
-        // Validate turn
-        auto turn_status = validate_turn( src );
-        if ( turn_status != pieces::move_status::valid ) {
-            return turn_status;
+        if ( move.flag() == game::move_flag::castling ) {
+            return threshold <= 0;
         }
 
-        // Get basic possible moves
-        possible_moves = game_board.possible_moves( src );
+        auto from  = move.from();
+        auto to    = move.to();
+        auto moved = game_board.piece_on( from );
+        if ( moved == game::no_piece ) {
+            return threshold <= 0;
+        }
 
-        // Add castling moves if applicable
-        add_castling_moves( board_copy, src, possible_moves );
+        auto captured = game_board.piece_on( to );
+        int  on_board = see_value( game::piece_type( moved ) );
+        int  swap     = ( captured == game::no_piece ? 0 : see_value( game::piece_type( captured ) ) ) - threshold;
+        if ( move.flag() == game::move_flag::promotion ) {
+            swap += see_value( pieces::name_t::queen ) - see_value( pieces::name_t::pawn );
+            on_board = see_value( pieces::name_t::queen );
+        }
 
-        // Filter out moves that would leave king in check
-        filter_illegal_moves( board_copy, src, possible_moves );
+        // keeping the capture for free is not enough
+        if ( swap < 0 ) {
+            return false;
+        }
 
-        return pieces::move_status::valid;
-    }
+        // losing the piece right back is still enough
+        swap = on_board - swap;
+        if ( swap <= 0 ) {
+            return true;
+        }
 
-    std::vector< game::space > chess_game::find_attackers( game::space const & src, bool const victim_color ) const
-    {
-        std::vector< game::space > attackers;
+        auto diagonal = diagonal_sliders( game_board );
+        auto straight = straight_sliders( game_board );
 
-        auto moves = legal_moves();
+        auto occupied  = game_board.occupancy() & ~game::square_bb( from ) & ~game::square_bb( to );
+        auto attackers = attackers_to( to, true, occupied ) | attackers_to( to, false, occupied );
+        bool colour    = game::piece_colour( moved );
 
-        for ( auto m : moves ) {
+        // result flips with every recapture, swap is what the side about to recapture has to win back
+        bool result = true;
+        while ( true ) {
+            colour = !colour;
+            attackers &= occupied;
 
-            if ( m.second == src ) {
-                if ( m.first.piece && m.first.piece->colour() && m.first.piece->colour() != victim_color ) {
-                    attackers.push_back( m.second );
-                }
+            auto own = attackers & game_board.colour_set( colour );
+            if ( !own ) {
+                break;
+            }
+
+            result  = !result;
+            auto sq = least_valuable( own, colour );
+
+            // the king can only take if nothing takes it back
+            auto type = game::piece_type( game_board.piece_on( sq ) );
+            if ( type == pieces::name_t::king ) {
+                return ( attackers & game_board.colour_set( !colour ) ) ? !result : result;
             }
+
+            swap = see_value( type ) - swap;
+            if ( swap < static_cast< int >( result ) ) {
+                break;
+            }
+
+            occupied ^= game::square_bb( sq );
+            attackers |= ( game::bishop_attacks( to, occupied ) & diagonal ) |
+                         ( game::rook_attacks( to, occupied ) & straight );
         }
 
-        return attackers;
+        return result;
     }
-
-}  // namespace chess
\ No newline at end of file
+}  // namespace chess
@@ -0,0 +1,192 @@
+#include <attacks.hpp>
+#include <game.hpp>
+
+namespace chess {
+
+    namespace {
+        // attacks of a knight or slider of the given type on sq
+        template < pieces::name_t type >
+        game::bitboard_t piece_attacks( game::square_t const sq, game::bitboard_t const occupied )
+        {
+            if constexpr ( type == pieces::name_t::knight ) {
+                return game::knight_attacks[sq];
+            }
+            else if constexpr ( type == pieces::name_t::bishop ) {
+                return game::bishop_attacks( sq, occupied );
+            }
+            else if constexpr ( type == pieces::name_t::rook ) {
+                return game::rook_attacks( sq, occupied );
+            }
+            else {
+                return game::queen_attacks( sq, occupied );
+            }
+        }
+
+        // moves every square in bb by step, a positive step goes up the board
+        template < int step >
+        constexpr game::bitboard_t shift( game::bitboard_t const bb )
+        {
+            return step > 0 ? bb << step : bb >> -step;
+        }
+    }  // namespace
+
+    template < game::gen_type type >
+    std::size_t chess_game::generate( game::move_list & moves ) const
+    {
+        auto count = moves.size();
+
+        if ( white_move() ) {
+            generate< type, true >( legality( true ), moves );
+        }
+        else if ( black_move() ) {
+            generate< type, false >( legality( false ), moves );
+        }
+
+        return moves.size() - count;
+    }
+
+    template < game::gen_type type >
+    std::size_t chess_game::generate( bool const colour, game::move_list & moves ) const
+    {
+        auto count = moves.size();
+
+        if ( colour ) {
+            generate< type, true >( legality( true ), moves );
+        }
+        else {
+            generate< type, false >( legality( false ), moves );
+        }
+
+        return moves.size() - count;
+    }
+
+    template < game::gen_type type, bool white >
+    void chess_game::generate( legality_t const & info, game::move_list & moves ) const
+    {
+        constexpr bool noisy = type == game::gen_type::captures;
+        constexpr bool quiet = type == game::gen_type::quiets;
+
+        // a side that is not in check has nothing to evade
+        if constexpr ( type == game::gen_type::evasions ) {
+            if ( !info.checkers ) {
+                return;
+            }
+        }
+
+        auto occupied = game_board.occupancy();
+        auto enemies  = game_board.colour_set( !white );
+        auto empty    = ~occupied;
+
+        // squares the king and the other pieces may land on for this kind of move
+        auto target = noisy ? enemies : quiet ? empty : ~game_board.colour_set( white );
+
+        // in double check only the king moves
+        if ( info.evasions ) {
+            constexpr int up   = white ? 8 : -8;
+            constexpr int west = up - 1;
+            constexpr int east = up + 1;
+
+            constexpr game::bitboard_t last_rank  = white ? game::rank_8_bb : game::rank_1_bb;
+            constexpr game::bitboard_t third_rank = white ? game::rank_1_bb << 16 : game::rank_1_bb << 40;
+
+            auto add_pawn_moves = [&]( game::bitboard_t targets, int const step ) {
+                for ( targets &= info.evasions; targets; ) {
+                    auto dst = game::pop_lsb( targets );
+                    auto src = dst - step;
+
+                    if ( game::is_set( info.pinned, src ) && !game::is_set( game::line_bb[info.king][src], dst ) ) {
+                        continue;
+                    }
+
+                    // pawns always promote to a queen
+                    if ( game::is_set( last_rank, dst ) ) {
+                        moves.push_back( { src, dst, game::move_flag::promotion, pieces::name_t::queen } );
+                    }
+                    else {
+                        moves.push_back( { src, dst } );
+                    }
+                }
+            };
+
+            // a pawn left on the back rank does not move
+            auto pawns = game_board.piece_set( pieces::name_t::pawn, white ) & ~( game::rank_1_bb | game::rank_8_bb );
+
+            auto single = shift< up >( pawns ) & empty;
+            auto pushes = single;
+            if constexpr ( noisy ) {
+                pushes &= last_rank;
+            }
+            else if constexpr ( quiet ) {
+                pushes &= ~last_rank;
+            }
+            add_pawn_moves( pushes, up );
+
+            if constexpr ( !noisy ) {
+                add_pawn_moves( shift< up >( single & third_rank ) & empty, 2 * up );
+            }
+
+            if constexpr ( !quiet ) {
+                add_pawn_moves( shift< west >( pawns & ~game::file_a_bb ) & enemies, west );
+                add_pawn_moves( shift< east >( pawns & ~game::file_h_bb ) & enemies, east );
+            }
+
+            auto add_piece_moves = [&]< pieces::name_t piece >() {
+                for ( auto from = game_board.piece_set( piece, white ); from; ) {
+                    auto src     = game::pop_lsb( from );
+                    auto targets = piece_attacks< piece >( src, occupied ) & target & info.evasions;
+
+                    if ( game::is_set( info.pinned, src ) ) {
+                        targets &= game::line_bb[info.king][src];
+                    }
+
+                    while ( targets ) {
+                        moves.push_back( { src, game::pop_lsb( targets ) } );
+                    }
+                }
+            };
+
+            add_piece_moves.template operator()< pieces::name_t::knight >();
+            add_piece_moves.template operator()< pieces::name_t::bishop >();
+            add_piece_moves.template operator()< pieces::name_t::rook >();
+            add_piece_moves.template operator()< pieces::name_t::queen >();
+        }
+
+        if ( info.king == game::num_squares ) {
+            return;
+        }
+
+        // the king must not block the attack on the square it steps back to
+        auto blockers = occupied ^ game::square_bb( info.king );
+        for ( auto targets = game::king_attacks[info.king] & target; targets; ) {
+            auto dst = game::pop_lsb( targets );
+            if ( !attackers_to( dst, !white, blockers ) ) {
+                moves.push_back( { info.king, dst } );
+            }
+        }
+
+        if constexpr ( type == game::gen_type::quiets || type == game::gen_type::legal ) {
+            // king side first
+            auto castles = castling_targets( white, info );
+            for ( int file : { 7, 3 } ) {
+                auto dst = game::make_square( white ? 1 : 8, file );
+                if ( game::is_set( castles, dst ) ) {
+                    moves.push_back( { info.king, dst, game::move_flag::castling } );
+                }
+            }
+        }
+    }
+
+    template std::size_t chess_game::generate< game::gen_type::captures >( game::move_list & moves ) const;
+    template std::size_t chess_game::generate< game::gen_type::quiets >( game::move_list & moves ) const;
+    template std::size_t chess_game::generate< game::gen_type::evasions >( game::move_list & moves ) const;
+    template std::size_t chess_game::generate< game::gen_type::legal >( game::move_list & moves ) const;
+
+    template std::size_t chess_game::generate< game::gen_type::captures >( bool const colour,
+                                                                          game::move_list & moves ) const;
+    template std::size_t chess_game::generate< game::gen_type::quiets >( bool const colour,
+                                                                        game::move_list & moves ) const;
+    template std::size_t chess_game::generate< game::gen_type::evasions >( bool const colour,
+                                                                          game::move_list & moves ) const;
+    template std::size_t chess_game::generate< game::gen_type::legal >( bool const colour,
+                                                                       game::move_list & moves ) const;
+}  // namespace chess
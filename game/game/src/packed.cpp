@@ -0,0 +1,53 @@
+#include <algorithm>
+#include <packed.hpp>
+#include <stdexcept>
+
+namespace chess::game {
+
+    packed_reader::packed_reader( std::istream & in, std::size_t const buffer_size ) :
+        in( in ), buffer( std::max< std::size_t >( buffer_size, 1 ) ), next( 0 ), count( 0 )
+    {
+    }
+
+    bool packed_reader::read( packed_position & position )
+    {
+        if ( next == count ) {
+            in.read( reinterpret_cast< char * >( buffer.data() ), buffer.size() * sizeof( packed_position ) );
+
+            auto bytes = static_cast< std::size_t >( in.gcount() );
+            if ( bytes % sizeof( packed_position ) ) {
+                throw std::runtime_error( "Truncated packed position record" );
+            }
+
+            next  = 0;
+            count = bytes / sizeof( packed_position );
+            if ( count == 0 ) {
+                return false;
+            }
+        }
+
+        position = buffer[next++];
+        return true;
+    }
+
+    packed_writer::packed_writer( std::ostream & out, std::size_t const buffer_size ) : out( out )
+    {
+        buffer.reserve( std::max< std::size_t >( buffer_size, 1 ) );
+    }
+
+    packed_writer::~packed_writer() { flush(); }
+
+    void packed_writer::write( packed_position const & position )
+    {
+        buffer.push_back( position );
+        if ( buffer.size() == buffer.capacity() ) {
+            flush();
+        }
+    }
+
+    void packed_writer::flush()
+    {
+        out.write( reinterpret_cast< char const * >( buffer.data() ), buffer.size() * sizeof( packed_position ) );
+        buffer.clear();
+    }
+}  // namespace chess::game
@@ -0,0 +1,130 @@
+#include <algorithm>
+#include <atomic>
+#include <game.hpp>
+#include <memory>
+#include <perft.hpp>
+#include <thread>
+
+namespace chess {
+
+    namespace {
+        // lockless entry, check holds key ^ data so a half written entry from another thread never matches
+        struct perft_entry {
+            std::atomic< std::uint64_t > check;
+            std::atomic< std::uint64_t > data;  // node count in the upper 56 bits, depth in the lower 8
+        };
+
+        class perft_cache {
+        private:
+            std::vector< perft_entry > entries;
+
+        public:
+            perft_cache( std::size_t const bytes ) :
+                entries( std::max< std::size_t >( bytes / sizeof( perft_entry ), 1 ) )
+            {
+            }
+
+            bool probe( game::zobrist_key_t const key, int const depth, std::uint64_t & nodes ) const
+            {
+                auto const & entry = entries[key % entries.size()];
+
+                std::uint64_t data = entry.data.load( std::memory_order_relaxed );
+                if ( ( entry.check.load( std::memory_order_relaxed ) ^ data ) != key ||
+                     ( data & 0xFF ) != static_cast< std::uint64_t >( depth ) ) {
+                    return false;
+                }
+
+                nodes = data >> 8;
+                return true;
+            }
+
+            void store( game::zobrist_key_t const key, int const depth, std::uint64_t const nodes )
+            {
+                auto & entry = entries[key % entries.size()];
+
+                std::uint64_t data = ( nodes << 8 ) | static_cast< std::uint64_t >( depth );
+                entry.check.store( key ^ data, std::memory_order_relaxed );
+                entry.data.store( data, std::memory_order_relaxed );
+            }
+        };
+
+        std::uint64_t perft( chess_game & game, int const depth, perft_cache * cache )
+        {
+            if ( depth <= 0 ) {
+                return 1;
+            }
+
+            auto moves = game.legal_moves();
+
+            // the leaves only need to be counted, not played
+            if ( depth == 1 ) {
+                return moves.size();
+            }
+
+            std::uint64_t nodes = 0;
+            if ( cache && cache->probe( game.hash(), depth, nodes ) ) {
+                return nodes;
+            }
+
+            for ( auto const move : moves ) {
+                game.make_move( move );
+                nodes += perft( game, depth - 1, cache );
+                game.unmake_move();
+            }
+
+            if ( cache ) {
+                cache->store( game.hash(), depth, nodes );
+            }
+
+            return nodes;
+        }
+    }  // namespace
+
+    std::uint64_t perft( chess_game & game, int const depth ) { return perft( game, depth, nullptr ); }
+
+    std::vector< std::pair< move_t, std::uint64_t > > perft_divide( chess_game const & game, int const depth,
+                                                                    perft_options const & options )
+    {
+        std::vector< std::pair< move_t, std::uint64_t > > results;
+
+        if ( depth <= 0 ) {
+            return results;
+        }
+
+        for ( auto const move : game.legal_moves() ) {
+            results.push_back( { move, 0 } );
+        }
+
+        std::unique_ptr< perft_cache > cache;
+        if ( options.cache_bytes > 0 ) {
+            cache = std::make_unique< perft_cache >( options.cache_bytes );
+        }
+
+        // each worker plays on its own copy and takes the next unclaimed root move
+        std::atomic< std::size_t > next = 0;
+        auto                       work = [&]() {
+            chess_game copy = game;
+
+            for ( auto i = next++; i < results.size(); i = next++ ) {
+                copy.make_move( results[i].first );
+                results[i].second = perft( copy, depth - 1, cache.get() );
+                copy.unmake_move();
+            }
+        };
+
+        auto num_threads = std::max< std::size_t >( std::min< std::size_t >( options.threads, results.size() ), 1 );
+
+        std::vector< std::thread > workers;
+        for ( std::size_t i = 1; i < num_threads; i++ ) {
+            workers.emplace_back( work );
+        }
+
+        work();
+
+        for ( auto & worker : workers ) {
+            worker.join();
+        }
+
+        return results;
+    }
+}  // namespace chess
@@ -206,6 +206,9 @@ namespace chess::pieces {
         std::unique_ptr< piece >        copy_piece() const;
         static std::unique_ptr< piece > copy_piece( piece const & piece );
 
+        // constructs a new piece of the given type at pos
+        static std::unique_ptr< piece > make_piece( name_t const type, bool const white, position_t const pos );
+
         // this helper function takes in the index of a rank and file and returns a position_t of it
         // returns the coordiantes that are theoretically reachable from this square
         static std::optional< position_t > itopos( int const rank, int const file );
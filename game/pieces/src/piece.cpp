@@ -29,26 +29,31 @@ namespace chess::pieces {
 
     // deep copy a piece
     std::unique_ptr< piece > piece::copy_piece( piece const & src )
+    {
+        return make_piece( src.type(), src.colour(), src.position() );
+    }
+
+    std::unique_ptr< piece > piece::make_piece( name_t const type, bool const white, position_t const pos )
     {
         std::unique_ptr< piece > cpy;
-        switch ( src.type() ) {
+        switch ( type ) {
         case name_t::rook:
-            cpy = std::make_unique< rook >( src.colour(), src.rank, src.file );
+            cpy = std::make_unique< rook >( white, pos.first, pos.second );
             break;
         case name_t::knight:
-            cpy = std::make_unique< knight >( src.colour(), src.rank, src.file );
+            cpy = std::make_unique< knight >( white, pos.first, pos.second );
             break;
         case name_t::bishop:
-            cpy = std::make_unique< bishop >( src.colour(), src.rank, src.file );
+            cpy = std::make_unique< bishop >( white, pos.first, pos.second );
             break;
         case name_t::king:
-            cpy = std::make_unique< king >( src.colour(), src.rank, src.file );
+            cpy = std::make_unique< king >( white, pos.first, pos.second );
             break;
         case name_t::queen:
-            cpy = std::make_unique< queen >( src.colour(), src.rank, src.file );
+            cpy = std::make_unique< queen >( white, pos.first, pos.second );
             break;
         case name_t::pawn:
-            cpy = std::make_unique< pawn >( src.colour(), src.rank, src.file );
+            cpy = std::make_unique< pawn >( white, pos.first, pos.second );
             break;
         }
 
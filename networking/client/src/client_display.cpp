@@ -40,7 +40,7 @@ namespace chess::networking {
 
         if ( game.selected_space->piece ) {
             if ( std::find( possible_moves.begin(), possible_moves.end(), sp ) != possible_moves.end() ) {
-                auto & selected_space_current = game.game_board.get( game.selected_space->position() );
+                auto selected_space_current = game.game_board.get( game.selected_space->position() );
                 if ( !selected_space_current.piece ) {
                     game.selected_space.reset();
                 }
@@ -0,0 +1,264 @@
+// consistency checks over random games: plays random legal moves from the start position and checks that the
+// incrementally maintained parts of chess_game agree with what they are derived from, exits with 1 on any failure
+
+#include <game.hpp>
+#include <move.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+    struct options_t {
+        int           games = 200;
+        int           plies = 200;
+        std::uint64_t seed  = 8120;
+    };
+
+    int failures = 0;
+
+    void fail( chess::chess_game const & game, std::string const & what )
+    {
+        // only the first few are printed, the count is reported at the end
+        if ( failures++ < 10 ) {
+            std::cout << "Failed: " << what << " in " << game.to_fen() << "\n";
+        }
+    }
+
+    // see_ge( move, t ) has to be see( move ) >= t for every threshold
+    void check_see( chess::chess_game const & game, chess::game::move_list const & moves )
+    {
+        for ( auto const & move : moves ) {
+            int value = game.see( move );
+            if ( !game.see_ge( move, value ) || game.see_ge( move, value + 1 ) ) {
+                fail( game, "see " + std::to_string( value ) + " and see_ge disagree on " +
+                                chess::game::to_string( move ) );
+            }
+        }
+    }
+
+    // evasions have to be the legal moves when the side to move is in check and nothing otherwise
+    void check_evasions( chess::chess_game const & game, chess::game::move_list const & moves )
+    {
+        chess::game::move_list evasions;
+        game.generate< chess::game::gen_type::evasions >( evasions );
+
+        bool check = game.get_state() == chess::game_state::white_check ||
+                     game.get_state() == chess::game_state::black_check;
+
+        if ( !check && !evasions.empty() ) {
+            fail( game, "evasions generated out of check" );
+        }
+        else if ( check && evasions.size() != moves.size() ) {
+            fail( game, std::to_string( evasions.size() ) + " evasions for " + std::to_string( moves.size() ) +
+                            " legal moves in check" );
+        }
+    }
+
+    // the attack map kept up to date by make_move has to match one counted from scratch
+    void check_attack_map( chess::chess_game const & game )
+    {
+        auto const & kept    = game.game_attack_map;
+        auto const   counted = game.generate_attack_map( game.get_board() );
+
+        for ( chess::game::square_t sq = 0; sq < chess::game::num_squares; sq++ ) {
+            if ( kept.attackers[0][sq] != counted.attackers[0][sq] ||
+                 kept.attackers[1][sq] != counted.attackers[1][sq] ||
+                 kept.attacks_from[sq] != counted.attacks_from[sq] ) {
+                fail( game, "attack map differs from the rebuilt one" );
+                return;
+            }
+        }
+
+        if ( kept.sources[0] != counted.sources[0] || kept.sources[1] != counted.sources[1] ) {
+            fail( game, "attack map sources differ from the rebuilt ones" );
+        }
+    }
+
+    // the incremental key has to match the key of the same position loaded from scratch, finished games included
+    void check_hash( chess::chess_game const & game )
+    {
+        chess::chess_game loaded;
+        loaded.load_from_fen( game.to_fen() );
+
+        if ( loaded.hash() != game.hash() ) {
+            fail( game, "incremental hash differs from the loaded one" );
+        }
+    }
+
+    // plays every legal move of the position and checks the hash after each, the position is left as it was
+    void check_hash_after_moves( chess::chess_game & game )
+    {
+        for ( auto const & move : game.legal_moves() ) {
+            game.make_move( move );
+            check_hash( game );
+            game.unmake_move();
+        }
+    }
+
+    // each promotion has to be recorded in the move history with the piece it promotes to, the generator only
+    // makes queens so the moves are built here
+    void check_promotion_history()
+    {
+        using chess::game::make_square;
+
+        chess::chess_game game;
+        game.load_from_fen( "k7/6P1/8/8/8/8/8/K7 w - - 0 1" );
+
+        for ( auto const piece : { chess::pieces::name_t::knight, chess::pieces::name_t::bishop,
+                                   chess::pieces::name_t::rook, chess::pieces::name_t::queen } ) {
+            chess::game::move move( make_square( 7, 7 ), make_square( 8, 7 ), chess::game::move_flag::promotion,
+                                    piece );
+
+            game.make_move( move );
+            auto expected = static_cast< char >( std::toupper( chess::game::to_string( move ).back() ) );
+            if ( game.get_move_history().back().back() != expected ) {
+                fail( game, "promotion recorded as " + game.get_move_history().back() );
+            }
+            game.unmake_move();
+        }
+    }
+
+    // castling rights without their king and rook on the home squares are dropped on load and never castle
+    void check_castling_rights()
+    {
+        std::pair< char const *, char const * > const cases[] = {
+            { "4k3/8/8/8/8/8/8/4K3 w KQkq - 0 1", "4k3/8/8/8/8/8/8/4K3 w - - 0 1" },
+            { "r3k2r/8/8/8/8/8/8/1R2K1R1 w KQkq - 0 1", "r3k2r/8/8/8/8/8/8/1R2K1R1 w kq - 0 1" },
+            { "r3k2r/8/8/8/8/8/8/R4K1R w KQkq - 0 1", "r3k2r/8/8/8/8/8/8/R4K1R w kq - 0 1" },
+        };
+
+        for ( auto const [fen, expected] : cases ) {
+            chess::chess_game game;
+            game.load_from_fen( fen );
+
+            if ( game.to_fen() != expected ) {
+                fail( game, std::string( "castling rights kept from " ) + fen );
+            }
+
+            for ( auto const & move : game.legal_moves() ) {
+                if ( move.flag() == chess::game::move_flag::castling ) {
+                    fail( game, "castles with " + chess::game::to_string( move ) );
+                }
+            }
+        }
+    }
+
+    // the packed loader drops castling rights as the FEN one does and refuses the reserved flag bits
+    void check_packed_flags()
+    {
+        chess::chess_game game;
+        game.load_from_fen( "4k3/8/8/8/8/8/8/4K3 w - - 0 1" );
+
+        auto packed = game.to_packed();
+        packed.flags |= 0x1E;  // KQkq
+
+        chess::chess_game loaded;
+        loaded.load_from_packed( packed );
+        if ( loaded.to_fen() != game.to_fen() ) {
+            fail( loaded, "packed castling rights kept without the king and rook on their squares" );
+        }
+
+        packed.flags |= 0xE0;
+        try {
+            loaded.load_from_packed( packed );
+            fail( loaded, "packed position with reserved flag bits loaded" );
+        }
+        catch ( std::invalid_argument const & ) {
+            // refused as it should be
+        }
+    }
+
+    // plays random moves in a bare kings ending, where nothing resets the halfmove clock, and checks is_repetition
+    // against the keys kept here for longer than the game keeps them
+    void check_repetition( std::mt19937_64 & rng, int const plies )
+    {
+        chess::chess_game                         game;
+        std::vector< chess::game::zobrist_key_t > keys;
+        game.load_from_fen( "8/8/8/4k3/8/8/8/4K3 w - - 0 1" );
+
+        for ( int ply = 0; ply < plies; ply++ ) {
+            auto moves = game.legal_moves();
+            keys.push_back( game.hash() );
+            game.make_move( moves[std::uniform_int_distribution< std::size_t >( 0, moves.size() - 1 )( rng )] );
+
+            // the game looks back at most 127 plies
+            bool        expected = false;
+            std::size_t window   = std::min< std::size_t >( keys.size(), 127 );
+            for ( std::size_t back = 4; back <= window; back += 2 ) {
+                expected = expected || keys[keys.size() - back] == game.hash();
+            }
+
+            if ( game.is_repetition() != expected ) {
+                fail( game, "is_repetition is wrong after " + std::to_string( ply + 1 ) + " plies" );
+            }
+        }
+    }
+}  // namespace
+
+int main( int argc, char ** argv )
+{
+    options_t options;
+
+    for ( int i = 1; i + 1 < argc; i += 2 ) {
+        std::string arg = argv[i];
+
+        if ( arg == "--games" ) {
+            options.games = std::stoi( argv[i + 1] );
+        }
+        else if ( arg == "--plies" ) {
+            options.plies = std::stoi( argv[i + 1] );
+        }
+        else if ( arg == "--seed" ) {
+            options.seed = std::stoull( argv[i + 1] );
+        }
+        else {
+            std::cout << "usage: chess_consistency [--games <n>] [--plies <n>] [--seed <n>]\n";
+            return 1;
+        }
+    }
+
+    std::mt19937_64 rng( options.seed );
+    std::uint64_t   positions = 0;
+
+    // positions with a mate and a stalemate among their moves, random games only rarely end
+    for ( auto const fen : { "7r/5k2/R6p/2pnP1p1/4p1P1/2K1P2B/q6P/8 w - - 10 58", "7k/5Q2/6K1/8/8/8/8/8 w - - 0 1" } ) {
+        chess::chess_game game;
+        game.load_from_fen( fen );
+        check_hash_after_moves( game );
+    }
+
+    check_promotion_history();
+    check_castling_rights();
+    check_packed_flags();
+    check_repetition( rng, 4 * options.plies );
+
+    for ( int g = 0; g < options.games; g++ ) {
+        chess::chess_game game;
+
+        for ( int ply = 0; ply < options.plies; ply++ ) {
+            auto moves = game.legal_moves();
+            if ( moves.empty() ) {
+                break;
+            }
+
+            positions++;
+            check_see( game, moves );
+            check_evasions( game, moves );
+
+            game.make_move( moves[std::uniform_int_distribution< std::size_t >( 0, moves.size() - 1 )( rng )] );
+            check_hash( game );
+            check_attack_map( game );
+        }
+    }
+
+    std::cout << positions << " positions, " << failures << " failures\n";
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,330 @@
+// differential perft: compares the divide counts of chess_game against the vendored Stockfish move generator on
+// random positions and writes a json report with node counts, timings and the first divergent line of every mismatch,
+// speed_ratio is Stockfish's time over ours so 1 means as fast as Stockfish
+
+#include <game.hpp>
+#include <move.hpp>
+#include <perft.hpp>
+
+#include "bitboard.h"
+#include "movegen.h"
+#include "position.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+    using clock_type = std::chrono::steady_clock;
+
+    struct options_t {
+        int           positions = 2000;
+        int           depth     = 3;
+        std::uint64_t seed      = 8120;
+        std::string   report    = "perft_diff.json";
+    };
+
+    struct result_t {
+        std::string                  fen;
+        std::uint64_t                nodes             = 0;
+        std::uint64_t                stockfish_nodes   = 0;
+        double                       seconds           = 0.0;
+        double                       stockfish_seconds = 0.0;
+        std::optional< std::string > divergence        = {};
+    };
+
+    // the engine has no en passant, always promotes to a queen and also needs the b-file square to be safe to castle
+    // queen-side, Stockfish's moves are filtered down to the same rules before they are counted
+    bool engine_allows( Stockfish::Position const & pos, Stockfish::Move const m )
+    {
+        using namespace Stockfish;
+
+        switch ( m.type_of() ) {
+        case EN_PASSANT:
+            return false;
+        case PROMOTION:
+            return m.promotion_type() == QUEEN;
+        case CASTLING:
+            if ( m.to_sq() < m.from_sq() ) {
+                Square b_file = make_square( FILE_B, rank_of( m.from_sq() ) );
+                return !( pos.attackers_to( b_file ) & pos.pieces( ~pos.side_to_move() ) );
+            }
+            return true;
+        default:
+            return true;
+        }
+    }
+
+    std::string to_uci( Stockfish::Move const m )
+    {
+        using namespace Stockfish;
+
+        Square from = m.from_sq();
+        Square to   = m.to_sq();
+
+        // Stockfish stores castling as the king taking its own rook
+        if ( m.type_of() == CASTLING ) {
+            to = make_square( to > from ? FILE_G : FILE_C, rank_of( from ) );
+        }
+
+        std::string uci = { char( 'a' + file_of( from ) ), char( '1' + rank_of( from ) ), char( 'a' + file_of( to ) ),
+                            char( '1' + rank_of( to ) ) };
+        if ( m.type_of() == PROMOTION ) {
+            uci += "  nbrq"[m.promotion_type()];
+        }
+        return uci;
+    }
+
+    std::uint64_t stockfish_perft( Stockfish::Position & pos, int const depth )
+    {
+        if ( depth == 0 ) {
+            return 1;
+        }
+
+        std::uint64_t        nodes = 0;
+        Stockfish::StateInfo st;
+
+        for ( auto const & m : Stockfish::MoveList< Stockfish::LEGAL >( pos ) ) {
+            if ( !engine_allows( pos, m ) ) {
+                continue;
+            }
+
+            if ( depth == 1 ) {
+                nodes++;
+                continue;
+            }
+
+            pos.do_move( m, st );
+            nodes += stockfish_perft( pos, depth - 1 );
+            pos.undo_move( m );
+        }
+        return nodes;
+    }
+
+    std::map< std::string, std::uint64_t > engine_divide( chess::chess_game const & game, int const depth )
+    {
+        std::map< std::string, std::uint64_t > divide;
+        for ( auto const & [move, nodes] : chess::perft_divide( game, depth ) ) {
+            divide[chess::game::to_string( move )] = nodes;
+        }
+        return divide;
+    }
+
+    std::map< std::string, std::uint64_t > stockfish_divide( Stockfish::Position & pos, int const depth )
+    {
+        std::map< std::string, std::uint64_t > divide;
+        Stockfish::StateInfo                   st;
+
+        for ( auto const & m : Stockfish::MoveList< Stockfish::LEGAL >( pos ) ) {
+            if ( !engine_allows( pos, m ) ) {
+                continue;
+            }
+
+            pos.do_move( m, st );
+            divide[to_uci( m )] = stockfish_perft( pos, depth - 1 );
+            pos.undo_move( m );
+        }
+        return divide;
+    }
+
+    // walks down the first root move whose counts differ until a move is missing on one side
+    std::string find_divergence( chess::chess_game & game, Stockfish::Position & pos, int const depth )
+    {
+        auto ours   = engine_divide( game, depth );
+        auto theirs = stockfish_divide( pos, depth );
+
+        for ( auto const & [uci, nodes] : theirs ) {
+            if ( !ours.contains( uci ) ) {
+                return uci + " (missing)";
+            }
+        }
+
+        for ( auto const & [uci, nodes] : ours ) {
+            auto it = theirs.find( uci );
+            if ( it == theirs.end() ) {
+                return uci + " (illegal)";
+            }
+            if ( it->second == nodes ) {
+                continue;
+            }
+
+            chess::move_t move;
+            for ( auto const m : game.legal_moves() ) {
+                if ( chess::game::to_string( m ) == uci ) {
+                    move = m;
+                }
+            }
+
+            Stockfish::Move sf_move = Stockfish::Move::none();
+            for ( auto const & m : Stockfish::MoveList< Stockfish::LEGAL >( pos ) ) {
+                if ( to_uci( m ) == uci ) {
+                    sf_move = m;
+                }
+            }
+
+            Stockfish::StateInfo st;
+            game.make_move( move );
+            pos.do_move( sf_move, st );
+
+            auto line = uci + " " + find_divergence( game, pos, depth - 1 );
+
+            pos.undo_move( sf_move );
+            game.unmake_move();
+
+            return line;
+        }
+
+        return "";
+    }
+
+    // plays a random number of random legal moves from the start position
+    std::string random_position( std::mt19937_64 & rng )
+    {
+        chess::chess_game game;
+
+        int plies = std::uniform_int_distribution( 4, 120 )( rng );
+        for ( int i = 0; i < plies; i++ ) {
+            auto moves = game.legal_moves();
+            if ( moves.empty() ) {
+                break;
+            }
+
+            game.make_move( moves[std::uniform_int_distribution< std::size_t >( 0, moves.size() - 1 )( rng )] );
+        }
+
+        return game.to_fen();
+    }
+
+    result_t compare( std::string const & fen, int const depth )
+    {
+        result_t result{ .fen = fen };
+
+        chess::chess_game game;
+        game.load_from_fen( fen );
+
+        Stockfish::StateInfo st;
+        Stockfish::Position  pos;
+        pos.set( fen, false, &st );
+
+        auto start     = clock_type::now();
+        result.nodes   = chess::perft( game, depth );
+        result.seconds = std::chrono::duration< double >( clock_type::now() - start ).count();
+
+        start                    = clock_type::now();
+        result.stockfish_nodes   = stockfish_perft( pos, depth );
+        result.stockfish_seconds = std::chrono::duration< double >( clock_type::now() - start ).count();
+
+        if ( result.nodes != result.stockfish_nodes ) {
+            result.divergence = find_divergence( game, pos, depth );
+        }
+
+        return result;
+    }
+
+    void write_report( options_t const & options, std::vector< result_t > const & results )
+    {
+        std::ofstream out( options.report );
+
+        double        seconds = 0, stockfish_seconds = 0;
+        std::uint64_t nodes = 0, mismatches = 0;
+        for ( auto const & r : results ) {
+            seconds += r.seconds;
+            stockfish_seconds += r.stockfish_seconds;
+            nodes += r.nodes;
+            mismatches += r.divergence.has_value();
+        }
+
+        out << "{\n";
+        out << "  \"depth\": " << options.depth << ",\n";
+        out << "  \"seed\": " << options.seed << ",\n";
+        out << "  \"positions\": " << results.size() << ",\n";
+        out << "  \"mismatches\": " << mismatches << ",\n";
+        out << "  \"nodes\": " << nodes << ",\n";
+        out << "  \"seconds\": " << seconds << ",\n";
+        out << "  \"stockfish_seconds\": " << stockfish_seconds << ",\n";
+        out << "  \"speed_ratio\": " << ( seconds > 0 ? stockfish_seconds / seconds : 0 ) << ",\n";
+        out << "  \"results\": [\n";
+
+        for ( std::size_t i = 0; i < results.size(); i++ ) {
+            auto const & r = results[i];
+            out << "    {\"fen\": \"" << r.fen << "\", \"nodes\": " << r.nodes
+                << ", \"stockfish_nodes\": " << r.stockfish_nodes << ", \"seconds\": " << r.seconds
+                << ", \"stockfish_seconds\": " << r.stockfish_seconds
+                << ", \"speed_ratio\": " << ( r.seconds > 0 ? r.stockfish_seconds / r.seconds : 0 )
+                << ", \"divergence\": ";
+
+            if ( r.divergence ) {
+                out << "\"" << *r.divergence << "\"";
+            }
+            else {
+                out << "null";
+            }
+
+            out << "}" << ( i + 1 < results.size() ? "," : "" ) << "\n";
+        }
+
+        out << "  ]\n}\n";
+    }
+}  // namespace
+
+int main( int argc, char ** argv )
+{
+    options_t options;
+
+    for ( int i = 1; i + 1 < argc; i += 2 ) {
+        std::string arg = argv[i];
+
+        if ( arg == "--positions" ) {
+            options.positions = std::stoi( argv[i + 1] );
+        }
+        else if ( arg == "--depth" ) {
+            options.depth = std::stoi( argv[i + 1] );
+        }
+        else if ( arg == "--seed" ) {
+            options.seed = std::stoull( argv[i + 1] );
+        }
+        else if ( arg == "--report" ) {
+            options.report = argv[i + 1];
+        }
+        else {
+            std::cout << "usage: chess_perft_diff [--positions <n>] [--depth <n>] [--seed <n>] [--report <file>]\n";
+            return 1;
+        }
+    }
+
+    Stockfish::Bitboards::init();
+    Stockfish::Position::init();
+
+    std::mt19937_64          rng( options.seed );
+    std::vector< result_t > results;
+    results.reserve( options.positions );
+
+    for ( int i = 0; i < options.positions; i++ ) {
+        results.push_back( compare( random_position( rng ), options.depth ) );
+
+        if ( results.back().divergence ) {
+            std::cout << "Mismatch: " << results.back().fen << "\n"
+                      << "  " << results.back().nodes << " nodes, Stockfish " << results.back().stockfish_nodes
+                      << ", diverges at " << *results.back().divergence << "\n";
+        }
+    }
+
+    write_report( options, results );
+
+    auto mismatches = std::count_if( results.begin(), results.end(), []( result_t const & r ) {
+        return r.divergence.has_value();
+    } );
+
+    std::cout << results.size() << " positions, " << mismatches << " mismatches, report written to "
+              << options.report << "\n";
+
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,102 @@
+// loading throughput: collects positions from random games and times loading them back from FEN and packed records
+
+#include <game.hpp>
+#include <move.hpp>
+#include <packed.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+    struct options_t {
+        int           positions = 2000;
+        int           rounds    = 500;
+        std::uint64_t seed      = 8120;
+    };
+
+    // positions reached by random legal moves from the start, a new game is started whenever one ends
+    std::vector< chess::chess_game > random_positions( options_t const & options )
+    {
+        std::mt19937_64                  rng( options.seed );
+        std::vector< chess::chess_game > positions;
+        chess::chess_game                game;
+
+        while ( static_cast< int >( positions.size() ) < options.positions ) {
+            auto moves = game.legal_moves();
+            if ( moves.empty() || game.fifty_move_rule() ) {
+                game = chess::chess_game();
+                continue;
+            }
+
+            game.make_move( moves[std::uniform_int_distribution< std::size_t >( 0, moves.size() - 1 )( rng )] );
+            positions.push_back( game );
+        }
+        return positions;
+    }
+
+    // runs load over every record options.rounds times and reports the loads per second
+    template < typename record_t, typename load_t >
+    void time_loads( std::string const & name, std::vector< record_t > const & records, options_t const & options,
+                     load_t && load )
+    {
+        chess::chess_game game;
+        std::uint64_t     keys = 0;
+
+        auto start = std::chrono::steady_clock::now();
+        for ( int round = 0; round < options.rounds; round++ ) {
+            for ( auto const & record : records ) {
+                load( game, record );
+                keys += game.hash();
+            }
+        }
+        auto end = std::chrono::steady_clock::now();
+
+        auto seconds = std::chrono::duration< double >( end - start ).count();
+        auto loads   = static_cast< double >( records.size() ) * options.rounds;
+
+        // the keys are printed so the loads can't be optimised away
+        std::cout << name << ": " << static_cast< std::uint64_t >( loads / seconds ) << " positions/s (" << std::hex
+                  << keys << std::dec << ")\n";
+    }
+}  // namespace
+
+int main( int argc, char ** argv )
+{
+    options_t options;
+
+    for ( int i = 1; i + 1 < argc; i += 2 ) {
+        std::string arg = argv[i];
+
+        if ( arg == "--positions" ) {
+            options.positions = std::stoi( argv[i + 1] );
+        }
+        else if ( arg == "--rounds" ) {
+            options.rounds = std::stoi( argv[i + 1] );
+        }
+        else if ( arg == "--seed" ) {
+            options.seed = std::stoull( argv[i + 1] );
+        }
+        else {
+            std::cout << "usage: chess_load_bench [--positions <n>] [--rounds <n>] [--seed <n>]\n";
+            return 1;
+        }
+    }
+
+    std::vector< std::string >                  fens;
+    std::vector< chess::game::packed_position > packed;
+    for ( auto const & game : random_positions( options ) ) {
+        fens.push_back( game.to_fen() );
+        packed.push_back( game.to_packed() );
+    }
+
+    time_loads( "fen", fens, options,
+                []( chess::chess_game & game, std::string const & fen ) { game.load_from_fen( fen ); } );
+    time_loads( "packed", packed, options,
+                []( chess::chess_game & game, chess::game::packed_position const & record ) {
+                    game.load_from_packed( record );
+                } );
+}
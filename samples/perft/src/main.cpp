@@ -0,0 +1,122 @@
+#include <game.hpp>
+#include <move.hpp>
+#include <perft.hpp>
+
+#include <cctype>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+namespace {
+    void usage()
+    {
+        std::cout << "usage: chess_perft <depth> [position] [--divide] [--threads <n>] [--cache <MiB>]\n"
+                  << "  position is a saved game (sample_pos.txt), a list of moves played from the start\n"
+                  << "  (4move_checkmate.txt) or a FEN string, the start position is used if it is left out\n";
+    }
+
+    chess::pieces::position_t parse_square( std::string const & square )
+    {
+        if ( square.size() != 2 ) {
+            throw std::invalid_argument( "Not a square: " + square );
+        }
+
+        auto pos = chess::pieces::piece::itopos( square[1] - '0', std::tolower( square[0] ) - 'a' + 1 );
+        if ( !pos ) {
+            throw std::invalid_argument( "Not a square: " + square );
+        }
+        return *pos;
+    }
+
+    // plays a whitespace separated list of source and destination squares from the start position
+    void play_moves( chess::chess_game & game, std::string const & moves )
+    {
+        std::istringstream iss( moves );
+        std::string        src, dst;
+
+        while ( iss >> src >> dst ) {
+            auto status = game.move( game.get( parse_square( src ) ), game.get( parse_square( dst ) ) );
+            if ( status != chess::pieces::move_status::valid ) {
+                throw std::invalid_argument( "Illegal move " + src + dst + ": " + chess::pieces::to_string( status ) );
+            }
+        }
+    }
+
+    void load_position( chess::chess_game & game, std::string const & position )
+    {
+        std::ifstream file( position );
+        if ( !file ) {
+            game.load_from_fen( position );
+            return;
+        }
+
+        std::ostringstream buffer;
+        buffer << file.rdbuf();
+        std::string contents = buffer.str();
+
+        if ( contents.find( "--- Game Metadata ---" ) != std::string::npos ) {
+            game.load_from_string( contents );
+        }
+        else {
+            play_moves( game, contents );
+        }
+    }
+}  // namespace
+
+int main( int argc, char ** argv )
+{
+    if ( argc < 2 ) {
+        usage();
+        return 1;
+    }
+
+    try {
+        int                  depth = std::stoi( argv[1] );
+        chess::perft_options options;
+        bool                 divide = false;
+        chess::chess_game    game;
+
+        for ( int i = 2; i < argc; i++ ) {
+            std::string arg = argv[i];
+
+            if ( arg == "--divide" ) {
+                divide = true;
+            }
+            else if ( arg == "--threads" && i + 1 < argc ) {
+                options.threads = std::stoul( argv[++i] );
+            }
+            else if ( arg == "--cache" && i + 1 < argc ) {
+                options.cache_bytes = std::stoull( argv[++i] ) << 20;
+            }
+            else {
+                load_position( game, arg );
+            }
+        }
+
+        auto start   = std::chrono::steady_clock::now();
+        auto results = chess::perft_divide( game, depth, options );
+        auto end     = std::chrono::steady_clock::now();
+
+        std::uint64_t nodes = depth <= 0 ? 1 : 0;
+        for ( auto const & [move, count] : results ) {
+            if ( divide ) {
+                std::cout << chess::game::to_string( move ) << ": " << count << "\n";
+            }
+            nodes += count;
+        }
+
+        auto seconds = std::chrono::duration< double >( end - start ).count();
+
+        std::cout << "\nNodes: " << nodes << "\n";
+        std::cout << "Time:  " << static_cast< std::uint64_t >( seconds * 1000 ) << " ms\n";
+        std::cout << "NPS:   " << static_cast< std::uint64_t >( seconds > 0 ? nodes / seconds : 0 ) << "\n";
+    }
+    catch ( std::exception const & e ) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+}
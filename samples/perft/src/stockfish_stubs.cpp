@@ -0,0 +1,32 @@
+// the differential perft only links Stockfish's board and move generator, these are the few symbols position.cpp
+// pulls in from the tablebase, transposition table and UCI code, none of which are used on that path
+
+#include "position.h"
+#include "syzygy/tbprobe.h"
+#include "tt.h"
+#include "uci.h"
+
+namespace Stockfish {
+    namespace Tablebases {
+        int MaxCardinality = 0;
+
+        WDLScore probe_wdl( Position &, ProbeState * result )
+        {
+            *result = FAIL;
+            return WDLDraw;
+        }
+
+        int probe_dtz( Position &, ProbeState * result )
+        {
+            *result = FAIL;
+            return 0;
+        }
+    }  // namespace Tablebases
+
+    TTEntry * TranspositionTable::first_entry( const Key ) const { return nullptr; }
+
+    std::string UCIEngine::square( Square s )
+    {
+        return std::string{ char( 'a' + file_of( s ) ), char( '1' + rank_of( s ) ) };
+    }
+}  // namespace Stockfish